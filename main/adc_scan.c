@@ -0,0 +1,112 @@
+#include "hal.h"
+#include "adc_scan.h"
+#include "filter.h"
+#include "history.h"
+#include "telemetry.h"
+#include "trace.h"
+
+/* CMDL values and hardware averaging in scan order, matching adc_scan_channel_t */
+static const hal_adc_scan_channel_t scan_channels[ADC_SCAN_CHANNELS] = {
+        {HAL_ADC_THERMISTOR,    7U}, // x128, temperature moves slowly
+        {HAL_ADC_PHOTODIODE,    5U}, // x32
+        {HAL_ADC_POTENTIOMETER, 4U}, // x16, keeps the knob responsive
+};
+
+/* Software stage after the hardware averaging */
+static filter_t filters[ADC_SCAN_CHANNELS];
+
+uint32_t adc_scan_ring[ADC_SCAN_RING_SCANS][ADC_SCAN_CHANNELS];
+
+static volatile adc_sample_t latest[ADC_SCAN_CHANNELS];
+static volatile adc_sample_t interval[ADC_SCAN_CHANNELS];
+static volatile uint32_t intervals = 0;
+static volatile uint32_t missed = 0;
+static uint32_t triggers;      // Trigger edges from the first scan to the last one
+static uint32_t last_trigger;  // Captured edge of the last scan
+
+static void adc_scan_latch(volatile adc_sample_t *sample, const adc_sample_t *from){
+    sample->value = from->value;
+    sample->raw = from->raw;
+    sample->timestamp = from->timestamp;
+    sample->sequence = from->sequence;
+}
+
+/* DMA interrupt: one complete scan landed in the ring */
+static void adc_scan_done(const uint32_t *results, uint32_t count, uint32_t trigger){
+    /* The edges are captured by the hardware, whole periods apart whatever the
+     * interrupt latency: a gap of more than one period is a trigger without a
+     * scan. The rounding only absorbs the capture synchronizer. */
+    TRACE_BEGIN(TRACE_ADC_SCAN_DONE);
+    uint32_t periods = 1;
+    if(triggers) periods = (trigger - last_trigger + ADC_SCAN_PERIOD_TICKS / 2U) / ADC_SCAN_PERIOD_TICKS;
+    if(periods == 0) periods = 1;
+    missed += periods - 1U;
+    last_trigger = trigger;
+
+    uint32_t before = triggers;
+    triggers += periods;
+    bool latch = (triggers / ADC_SCAN_INTERVAL_SCANS) != (before / ADC_SCAN_INTERVAL_SCANS);
+
+    adc_sample_t sample;
+    uint16_t values[ADC_SCAN_CHANNELS] = {0};
+    sample.timestamp = trigger;
+    sample.sequence = triggers;
+    for(uint32_t i = 0; i < count; i++){
+        uint32_t cmd = HAL_ADC_RESULT_CMD(results[i]);
+        if(cmd == 0 || cmd > ADC_SCAN_CHANNELS) continue;
+        sample.raw = HAL_ADC_RESULT_VALUE(results[i]);
+        sample.value = filter_update(&filters[cmd - 1U], sample.raw);
+        adc_scan_latch(&latest[cmd - 1U], &sample);
+        history_add((adc_scan_channel_t)(cmd - 1U), sample.value);
+        values[cmd - 1U] = sample.value;
+        if(latch) adc_scan_latch(&interval[cmd - 1U], &sample);
+    }
+    if(latch) intervals++;
+    telemetry_scan(values);
+    TRACE_END(TRACE_ADC_SCAN_DONE);
+}
+
+void adc_scan_start(){
+    filter_init(&filters[ADC_SCAN_THERMISTOR], FILTER_IIR, 3U);           // 80 ms time constant
+    filter_init(&filters[ADC_SCAN_PHOTODIODE], FILTER_MOVING_AVERAGE, 0U); // Last 80 ms
+    filter_init(&filters[ADC_SCAN_POTENTIOMETER], FILTER_MEDIAN, 0U);      // Drops wiper spikes
+    history_reset();
+    triggers = 0;
+    hal_adc_scan_start(scan_channels, ADC_SCAN_CHANNELS, &adc_scan_ring[0][0], ADC_SCAN_RING_SCANS,
+                       ADC_SCAN_PERIOD_TICKS, adc_scan_done);
+}
+
+void adc_scan_stop(){
+    hal_adc_scan_stop();
+}
+
+static adc_sample_t adc_scan_copy(volatile adc_sample_t *from){
+    adc_sample_t sample;
+    hal_irq_disable();
+    sample.value = from->value;
+    sample.raw = from->raw;
+    sample.timestamp = from->timestamp;
+    sample.sequence = from->sequence;
+    hal_irq_enable();
+    return sample;
+}
+
+adc_sample_t adc_scan_latest(adc_scan_channel_t channel){
+    return adc_scan_copy(&latest[channel]);
+}
+
+uint16_t adc_scan_value(adc_scan_channel_t channel){
+    return latest[channel].value;
+}
+
+adc_sample_t adc_scan_interval(adc_scan_channel_t channel){
+    return adc_scan_copy(&interval[channel]);
+}
+
+uint32_t adc_scan_intervals(){
+    return intervals;
+}
+
+uint32_t adc_scan_missed(){
+    return missed;
+}
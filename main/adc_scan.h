@@ -0,0 +1,59 @@
+#ifndef ADC_SCAN_H_
+#define ADC_SCAN_H_
+
+#include "hal.h"
+
+/*
+ * ADC SCAN SERVICE
+ * Samples the thermistor, photodiode and potentiometer in the background
+ * (CTIMER1 trigger -> LPADC command chain -> FIFO -> EDMA ring buffer) and
+ * keeps the latest sample of each channel with its timestamp. Readers never
+ * touch the ADC, so switching modules cannot race on a shared conversion result.
+ * Scans start on a hardware edge every ADC_SCAN_PERIOD_TICKS and each one is
+ * stamped with the edge time latched by the timer, so sample n was taken
+ * exactly n - 1 periods after sample 1, however busy the UI is.
+ * Each channel has its own hardware averaging and software filter (filter.h);
+ * the sensors keep their filtered scans in a downsampled history (history.h).
+ */
+
+#define ADC_SCAN_RING_SCANS HAL_ADC_SCAN_MAX_SCANS
+
+#define ADC_SCAN_PERIOD_TICKS   (HAL_TIMER_CLOCK_HZ / 100U) // 10 ms
+#define ADC_SCAN_INTERVAL_SCANS 3000U                       // 30 s display/log interval
+
+typedef enum {
+    ADC_SCAN_THERMISTOR = 0,
+    ADC_SCAN_PHOTODIODE,
+    ADC_SCAN_POTENTIOMETER,
+    ADC_SCAN_CHANNELS
+} adc_scan_channel_t;
+
+typedef struct {
+    uint16_t value;      // Filtered 16-bit result
+    uint16_t raw;        // Hardware-averaged result before the software filter
+    uint32_t timestamp;  // hal_ticks() at the trigger edge that started the scan (hardware capture)
+    uint32_t sequence;   // Trigger number counted from the first scan (1), 0 = no sample yet
+} adc_sample_t;
+
+/* Raw FIFO words of the last ADC_SCAN_RING_SCANS scans */
+extern uint32_t adc_scan_ring[ADC_SCAN_RING_SCANS][ADC_SCAN_CHANNELS];
+
+void adc_scan_start();
+
+void adc_scan_stop();
+
+/* Latest (filtered) sample of a channel, O(1) and non-blocking */
+adc_sample_t adc_scan_latest(adc_scan_channel_t channel);
+
+uint16_t adc_scan_value(adc_scan_channel_t channel);
+
+/* Sample latched on the last multiple of ADC_SCAN_INTERVAL_SCANS */
+adc_sample_t adc_scan_interval(adc_scan_channel_t channel);
+
+/* Number of intervals latched so far, changes exactly every 30 s */
+uint32_t adc_scan_intervals();
+
+/* Trigger periods that passed without a completed scan */
+uint32_t adc_scan_missed();
+
+#endif /* ADC_SCAN_H_ */
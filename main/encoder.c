@@ -0,0 +1,90 @@
+#include "hal.h"
+#include "encoder.h"
+
+/* (A << 1) | B of the two channels in a port snapshot */
+#define ENCODER_STATE(port) ((((port) >> SHIELD_ROTARY_1_GPIO_PIN) & 1U) << 1 | \
+                             (((port) >> SHIELD_ROTARY_2_GPIO_PIN) & 1U))
+
+#define ENCODER_ERROR 2  // Both channels changed
+
+/* Indexed by (old << 2) | new. Clockwise runs 00 -> 10 -> 11 -> 01 -> 00,
+ * channel B following A, as in the original polling decoder. */
+static const int8_t transitions[16] = {
+        /* old 00 */  0,            -1,            +1,            ENCODER_ERROR,
+        /* old 01 */ +1,             0,            ENCODER_ERROR, -1,
+        /* old 10 */ -1,             ENCODER_ERROR, 0,            +1,
+        /* old 11 */  ENCODER_ERROR, +1,           -1,             0,
+};
+
+volatile encoder_stats_t encoder_stats;
+
+static uint8_t state;
+static volatile int32_t position;
+static volatile int32_t velocity;     // Counts/s, smoothed
+static volatile uint32_t last_edge;   // hal_ticks() of the last valid transition
+static int32_t taken;                 // Position handed out by encoder_take()
+
+void encoder_start(){
+    state = ENCODER_STATE(hal_gpio_port_read(ENCODER_PORT));
+    position = 0;
+    velocity = 0;
+    taken = 0;
+    last_edge = hal_ticks();
+    hal_gpio_edge_irq(ENCODER_PORT, SHIELD_ROTARY_1_GPIO_PIN, 1);
+    hal_gpio_edge_irq(ENCODER_PORT, SHIELD_ROTARY_2_GPIO_PIN, 1);
+}
+
+void encoder_stop(){
+    hal_gpio_edge_irq(ENCODER_PORT, SHIELD_ROTARY_1_GPIO_PIN, 0);
+    hal_gpio_edge_irq(ENCODER_PORT, SHIELD_ROTARY_2_GPIO_PIN, 0);
+}
+
+void encoder_edge(){
+    uint32_t now = hal_ticks();
+    uint8_t next = ENCODER_STATE(hal_gpio_port_read(ENCODER_PORT));
+    int8_t step = transitions[(state << 2) | next];
+    state = next;
+
+    if(step == 0) return; // Bounce back to the same state, or the other pin of a shared port
+    if(step == ENCODER_ERROR){
+        encoder_stats.errors++;
+        return;
+    }
+    position += step;
+    encoder_stats.edges++;
+
+    uint32_t rate = HAL_TIMER_CLOCK_HZ / ((now - last_edge) | 1U);
+    if(rate > encoder_stats.max_rate) encoder_stats.max_rate = rate;
+    int32_t instant = (step > 0) ? (int32_t)rate : -(int32_t)rate;
+    velocity += (instant - velocity) >> ENCODER_VELOCITY_SHIFT;
+    last_edge = now;
+}
+
+int32_t encoder_position(){
+    return position;
+}
+
+int32_t encoder_velocity(){
+    hal_irq_disable();
+    int32_t v = velocity;
+    uint32_t since = hal_ticks() - last_edge;
+    hal_irq_enable();
+
+    if(since > ENCODER_IDLE_MS * (HAL_TIMER_CLOCK_HZ / 1000U)) return 0;
+    /* No edge for 'since' ticks: the rate is at most one count per that time */
+    int32_t bound = (int32_t)(HAL_TIMER_CLOCK_HZ / (since | 1U));
+    if(v > bound) return bound;
+    if(v < -bound) return -bound;
+    return v;
+}
+
+int32_t encoder_take(){
+    int32_t steps = (position - taken) / (int32_t)ENCODER_COUNTS_PER_STEP;
+    if(steps == 0) return 0;
+    taken += steps * (int32_t)ENCODER_COUNTS_PER_STEP;
+
+    int32_t v = encoder_velocity();
+    uint32_t factor = 1U + (uint32_t)((v < 0) ? -v : v) / ENCODER_ACCEL_RATE;
+    if(factor > ENCODER_ACCEL_MAX) factor = ENCODER_ACCEL_MAX;
+    return steps * (int32_t)factor;
+}
@@ -0,0 +1,51 @@
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+#include "hal.h"
+
+/*
+ * ROTARY ENCODER
+ * Both channels interrupt on either edge. The handler reads them together
+ * in one port snapshot and looks the old and new (A,B) states up in a
+ * 16-entry transition table: +1/-1 for a valid 4x quadrature step, 0 for
+ * no change, and an error for a double step (both channels moved before
+ * the handler ran), which means the step rate exceeded the interrupt
+ * latency. The time between edges gives a velocity estimate, which
+ * scales the steps handed to the application (acceleration).
+ */
+
+#define ENCODER_PORT     HAL_PORT3
+#define ENCODER_PIN_MASK ((1UL << SHIELD_ROTARY_1_GPIO_PIN) | (1UL << SHIELD_ROTARY_2_GPIO_PIN))
+
+#define ENCODER_COUNTS_PER_STEP 2U    // Counts per application step, one per channel B edge
+#define ENCODER_ACCEL_RATE      400U  // Counts/s for each extra step per step
+#define ENCODER_ACCEL_MAX       4U    // Largest step multiplier
+#define ENCODER_IDLE_MS         250U  // No edge for this long: velocity 0
+#define ENCODER_VELOCITY_SHIFT  2U    // Smoothing of the velocity estimate, 1/4 per edge
+
+typedef struct {
+    uint32_t edges;     // Valid transitions
+    uint32_t errors;    // Double steps, direction unknown
+    uint32_t max_rate;  // Highest instantaneous rate seen, counts/s
+} encoder_stats_t;
+
+extern volatile encoder_stats_t encoder_stats;
+
+/* Latches the current channel states, clears the position and enables the edge interrupts */
+void encoder_start();
+
+void encoder_stop();
+
+/* Edge handler, called from the GPIO interrupt */
+void encoder_edge();
+
+/* Counts since encoder_start(), positive clockwise */
+int32_t encoder_position();
+
+/* Counts per second, positive clockwise, 0 when idle */
+int32_t encoder_velocity();
+
+/* Steps since the last call, multiplied by the acceleration factor */
+int32_t encoder_take();
+
+#endif /* ENCODER_H_ */
@@ -0,0 +1,77 @@
+#include "hal.h"
+#include "entropy.h"
+#include "trace.h"
+
+entropy_stats_t entropy_stats;
+
+/* 64-bit finalizer of MurmurHash3, every input bit reaches every output bit */
+static uint64_t entropy_mix(uint64_t x){
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB3F91A1F8E5BULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/* Repetition count and adaptive proportion tests over one block of raw bits */
+static bool entropy_healthy(const uint16_t *samples){
+    uint32_t first = (samples[0] >> ENTROPY_ADC_BIT) & 1U;
+    uint32_t previous = first, run = 1, same = 1;
+    bool healthy = 1;
+
+    for(uint32_t i = 1; i < ENTROPY_ADC_BITS; i++){
+        uint32_t bit = (samples[i] >> ENTROPY_ADC_BIT) & 1U;
+        run = (bit == previous) ? run + 1U : 1U;
+        previous = bit;
+        same += (bit == first);
+        if(run == ENTROPY_REPETITION_CUTOFF){
+            entropy_stats.repetition_failures++;
+            healthy = 0;
+        }
+    }
+    if(same >= ENTROPY_PROPORTION_CUTOFF){
+        entropy_stats.proportion_failures++;
+        healthy = 0;
+    }
+    return healthy;
+}
+
+/* Packs the noise bits of a block into words and folds them into 'pool' */
+static uint64_t entropy_condition(uint64_t pool, const uint16_t *samples){
+    for(uint32_t i = 0; i < ENTROPY_ADC_BITS; i += 32U){
+        uint32_t word = 0;
+        for(uint32_t b = 0; b < 32U; b++) word |= (uint32_t)((samples[i + b] >> ENTROPY_ADC_BIT) & 1U) << b;
+        pool = entropy_mix(pool ^ word);
+    }
+    return pool;
+}
+
+entropy_source_t entropy_seed(uint64_t *seed){
+    uint32_t start = hal_ticks();
+    uint32_t words[2];
+
+    if(hal_trng_read(words, 2U)){
+        *seed = ((uint64_t)words[1] << 32) | words[0];
+        entropy_stats.source = ENTROPY_SOURCE_TRNG;
+    } else {
+        static uint16_t samples[ENTROPY_ADC_BITS];
+        uint64_t pool = 0;
+        entropy_stats.source = ENTROPY_SOURCE_NONE;
+        for(uint32_t attempt = 0; attempt < ENTROPY_ADC_ATTEMPTS; attempt++){
+            TRACE_BEGIN(TRACE_ADC_BURST);
+            hal_adc_burst(HAL_ADC_FLOATING, samples, ENTROPY_ADC_BITS);
+            TRACE_END(TRACE_ADC_BURST);
+            entropy_stats.adc_blocks++;
+            bool healthy = entropy_healthy(samples);
+            pool = entropy_condition(pool, samples);
+            if(healthy){
+                entropy_stats.source = ENTROPY_SOURCE_ADC;
+                break;
+            }
+        }
+        *seed = pool;
+    }
+    entropy_stats.ticks = hal_ticks() - start;
+    return entropy_stats.source;
+}
@@ -0,0 +1,48 @@
+#ifndef ENTROPY_H_
+#define ENTROPY_H_
+
+#include "hal.h"
+
+/*
+ * ENTROPY SOURCE
+ * Collects the 64-bit seed for the random number generator (rng.h) at boot.
+ * The hardware TRNG is used when the part has one. Otherwise the floating ADC
+ * pin is read in FIFO bursts and one noise bit is kept per conversion. Those
+ * raw bits pass the two SP 800-90B health tests, repetition count and
+ * adaptive proportion, sized for an assumed 0.5 bit of min-entropy per bit.
+ * Every block of 256 bits is folded into the seed with a 64-bit mixing
+ * function, but only a block that passes ends the collection; after
+ * ENTROPY_ADC_ATTEMPTS failures the pin is reported as no source.
+ * Runs with the ADC scan stopped.
+ */
+
+#define ENTROPY_ADC_BITS     256U  // Raw bits per block, one per conversion
+#define ENTROPY_ADC_BIT      4U    // Noise bit of the 16-bit result
+#define ENTROPY_ADC_ATTEMPTS 3U    // Blocks tried before giving up on the pin
+
+/* Cutoffs for 0.5 bit/bit at a false alarm rate of 2^-20. The proportion
+ * test window is reduced from SP 800-90B's 512 to one block of 256 bits,
+ * its cutoff is 1 + critbinom(255, 2^-0.5, 1 - 2^-20) = 214. */
+#define ENTROPY_REPETITION_CUTOFF 41U   // 1 + 20 / 0.5 identical bits in a row
+#define ENTROPY_PROPORTION_CUTOFF 214U  // Same bit as the first, out of ENTROPY_ADC_BITS
+
+typedef enum {
+    ENTROPY_SOURCE_NONE = 0,  // Every ADC block failed, the seed is not to be trusted
+    ENTROPY_SOURCE_TRNG,
+    ENTROPY_SOURCE_ADC
+} entropy_source_t;
+
+typedef struct {
+    entropy_source_t source;       // Source of the last seed
+    uint32_t adc_blocks;           // ADC blocks collected, passed or not
+    uint32_t repetition_failures;
+    uint32_t proportion_failures;
+    uint32_t ticks;                // hal_ticks() spent in the last entropy_seed()
+} entropy_stats_t;
+
+extern entropy_stats_t entropy_stats;
+
+/* Returns the source that filled 'seed' */
+entropy_source_t entropy_seed(uint64_t *seed);
+
+#endif /* ENTROPY_H_ */
@@ -0,0 +1,74 @@
+#include "hal.h"
+#include "filter.h"
+
+void filter_init(filter_t *filter, filter_kind_t kind, uint8_t shift){
+    filter->kind = kind;
+    filter->shift = shift;
+    filter->seeded = 0;
+    filter->pos = 0;
+    filter->acc = 0;
+}
+
+static void filter_seed(filter_t *filter, uint16_t sample){
+    for(uint32_t i = 0; i < FILTER_WINDOW; i++) filter->window[i] = sample;
+    filter->acc = (filter->kind == FILTER_IIR) ? ((uint32_t)sample << filter->shift)
+                                               : (uint32_t)sample * FILTER_WINDOW;
+    filter->seeded = 1;
+}
+
+/* Insertion sort of the last taps, newest first in the window */
+static uint16_t filter_median(filter_t *filter){
+    uint16_t taps[FILTER_MEDIAN_TAPS];
+    for(uint32_t i = 0; i < FILTER_MEDIAN_TAPS; i++){
+        uint16_t value = filter->window[(filter->pos - 1U - i) & (FILTER_WINDOW - 1U)];
+        uint32_t j = i;
+        while(j > 0 && taps[j - 1U] > value){
+            taps[j] = taps[j - 1U];
+            j--;
+        }
+        taps[j] = value;
+    }
+    return taps[FILTER_MEDIAN_TAPS / 2U];
+}
+
+uint16_t filter_update(filter_t *filter, uint16_t sample){
+    if(!filter->seeded) filter_seed(filter, sample);
+
+    switch(filter->kind){
+    case FILTER_IIR:
+        filter->acc = filter->acc - (filter->acc >> filter->shift) + sample;
+        return (uint16_t)(filter->acc >> filter->shift);
+
+    case FILTER_MOVING_AVERAGE:
+        filter->acc += sample;
+        filter->acc -= filter->window[filter->pos];
+        filter->window[filter->pos] = sample;
+        filter->pos = (filter->pos + 1U) & (FILTER_WINDOW - 1U);
+        return (uint16_t)(filter->acc >> FILTER_WINDOW_BITS);
+
+    case FILTER_MEDIAN:
+        filter->window[filter->pos] = sample;
+        filter->pos = (filter->pos + 1U) & (FILTER_WINDOW - 1U);
+        return filter_median(filter);
+
+    default:
+        return sample;
+    }
+}
+
+void filter_change_init(filter_change_t *change, uint16_t hysteresis){
+    change->hysteresis = hysteresis;
+    change->value = 0;
+    change->seeded = 0;
+}
+
+bool filter_change_update(filter_change_t *change, uint16_t sample){
+    if(change->seeded &&
+       sample <= change->value + change->hysteresis &&
+       sample + change->hysteresis >= change->value){
+        return 0;
+    }
+    change->value = sample;
+    change->seeded = 1;
+    return 1;
+}
@@ -0,0 +1,55 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include "hal.h"
+
+/*
+ * SAMPLE FILTERS
+ * Integer filters run on every scan from the ADC interrupt, after the
+ * hardware averaging of the LPADC:
+ *  - IIR: first order low-pass, y += (x - y) / 2^shift
+ *  - moving average over the last FILTER_WINDOW samples
+ *  - median of the last FILTER_MEDIAN_TAPS samples, rejects single spikes
+ * The first sample seeds the state, so there is no ramp up from zero.
+ * The change detector sits on the reader side and only reports a value
+ * that left the hysteresis band around the last reported one.
+ */
+
+#define FILTER_WINDOW      8U // Power of two
+#define FILTER_WINDOW_BITS 3U
+#define FILTER_MEDIAN_TAPS 5U
+
+typedef enum {
+    FILTER_NONE = 0,
+    FILTER_IIR,
+    FILTER_MOVING_AVERAGE,
+    FILTER_MEDIAN
+} filter_kind_t;
+
+typedef struct {
+    filter_kind_t kind;
+    uint8_t shift;                  // IIR time constant, in samples: 2^shift
+    bool seeded;
+    uint8_t pos;
+    uint32_t acc;                   // IIR: output << shift, moving average: window sum
+    uint16_t window[FILTER_WINDOW];
+} filter_t;
+
+typedef struct {
+    uint16_t hysteresis;
+    uint16_t value;                 // Last reported value
+    bool seeded;
+} filter_change_t;
+
+void filter_init(filter_t *filter, filter_kind_t kind, uint8_t shift);
+
+/* Feeds one sample and returns the filtered value */
+uint16_t filter_update(filter_t *filter, uint16_t sample);
+
+void filter_change_init(filter_change_t *change, uint16_t hysteresis);
+
+/* Returns 1 (and takes the new value) when 'sample' is more than 'hysteresis' away
+ * from the last reported value; the first call always reports */
+bool filter_change_update(filter_change_t *change, uint16_t sample);
+
+#endif /* FILTER_H_ */
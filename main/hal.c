@@ -0,0 +1,31 @@
+#include "hal.h"
+
+/* Per-module counters shared by the board and simulator backends */
+hal_stats_t hal_stats[HAL_MOD_COUNT];
+hal_module_t hal_module = HAL_MOD_MENU;
+
+void hal_set_module(hal_module_t module){
+    hal_module = module;
+}
+
+void hal_reset_stats(){
+    for(int i = 0; i < HAL_MOD_COUNT; i++){
+        hal_stats[i] = (hal_stats_t){0};
+    }
+}
+
+uint32_t hal_idle_permille(hal_module_t module){
+    if(hal_stats[module].cycles == 0) return 0;
+    return (uint32_t)(hal_stats[module].idle_cycles * 1000U / hal_stats[module].cycles);
+}
+
+uint32_t hal_current_ua(hal_module_t module){
+    uint32_t idle = hal_idle_permille(module);
+    return (HAL_RUN_CURRENT_UA * (1000U - idle) + HAL_SLEEP_CURRENT_UA * idle) / 1000U;
+}
+
+void hal_idle(){
+    hal_irq_disable();
+    hal_sleep();
+    hal_irq_enable();
+}
@@ -0,0 +1,240 @@
+#ifndef HAL_H_
+#define HAL_H_
+
+/*
+ * HARDWARE ABSTRACTION LAYER
+ * Thin wrapper over the peripherals used by the application modules
+ * (GPIO, LPADC, CTIMERs, I2C, sleep). The board backend (hal_mcx.c) forwards to the
+ * NXP SDK, the host backend (sim/hal_sim.c) runs the same modules on Linux
+ * against virtual hardware when the project is built with HOST_SIM.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef HOST_SIM
+#include "sim_board.h"
+#else
+#include "board.h"
+#include "app.h"
+#include "peripherals.h"
+#include "pin_mux.h"
+#include "clock_config.h"
+#include "MCXN947_cm33_core0.h"
+#include "fsl_debug_console.h"
+#include "fsl_lpi2c.h"
+#include "fsl_device_registers.h"
+#endif
+
+/* GPIO port indexes (GPIO0..GPIO4) */
+#define HAL_PORT0 0U
+#define HAL_PORT1 1U
+#define HAL_PORT2 2U
+#define HAL_PORT3 3U
+#define HAL_PORT4 4U
+#define HAL_PORT_COUNT 5U
+
+/* LPADC command (CMDL) values for the analog inputs */
+#define HAL_ADC_POTENTIOMETER 0x00U
+#define HAL_ADC_FLOATING      0x00U
+#define HAL_ADC_THERMISTOR    0x03U
+#define HAL_ADC_PHOTODIODE    0x20U
+
+/* CTIMER0..2 count at the core clock */
+#define HAL_TIMER_CLOCK_HZ 150000000U
+
+/* Typical supply current of the MCU at 150 MHz, running and in WFI sleep (uA).
+ * Only used to estimate the average current from the idle time. */
+#define HAL_RUN_CURRENT_UA   9000U
+#define HAL_SLEEP_CURRENT_UA 3500U
+
+/* Modules that the per-module statistics are accounted to */
+typedef enum {
+    HAL_MOD_MENU = 0,
+    HAL_MOD_TEMPERATURE,
+    HAL_MOD_LIGHT,
+    HAL_MOD_GAME,
+    HAL_MOD_LEDS,
+    HAL_MOD_COUNT
+} hal_module_t;
+
+typedef struct {
+    uint64_t cycles;          // Time spent in the module, running or asleep
+    uint64_t idle_cycles;     // Part of it spent asleep in hal_sleep()
+    uint32_t wakeups;
+    uint32_t i2c_bytes;       // Bytes on the OLED bus, including address and control bytes
+    uint32_t gpio_writes;
+    uint32_t gpio_reads;
+    uint32_t adc_conversions;
+} hal_stats_t;
+
+extern hal_stats_t hal_stats[HAL_MOD_COUNT];
+extern hal_module_t hal_module;
+
+/* Board bring-up for the HAL itself (DMA, timebase), called once from main() */
+void hal_init();
+
+/* Free-running 150 MHz counter used for timestamps, keeps counting in sleep (wraps every ~28 s) */
+uint32_t hal_ticks();
+
+/* Selects the module that following HAL operations are accounted to */
+void hal_set_module(hal_module_t module);
+
+void hal_reset_stats();
+
+/* Share of the module's time spent asleep, in 0.1 % */
+uint32_t hal_idle_permille(hal_module_t module);
+
+/* Average supply current of the module estimated from its idle time */
+uint32_t hal_current_ua(hal_module_t module);
+
+/* --- GPIO --- */
+uint8_t hal_gpio_read(uint8_t port, uint32_t pin);
+
+void hal_gpio_write(uint8_t port, uint32_t pin, uint8_t value);
+
+/* All input pins of the port in one register read (PDIR) */
+uint32_t hal_gpio_port_read(uint8_t port);
+
+/* Routes both edges of an input pin to the port's interrupt 0, or disables them */
+void hal_gpio_edge_irq(uint8_t port, uint32_t pin, bool enable);
+
+/* Flips every output pin of 'mask' on the port in one register write (PTOR) */
+void hal_gpio_port_toggle(uint8_t port, uint32_t mask);
+
+/* Drives every output pin of 'mask' on the port low in one register write (PCOR) */
+void hal_gpio_port_clear(uint8_t port, uint32_t mask);
+
+/* --- GPIO STREAM (CTIMER3 + EDMA) --- */
+
+#define HAL_GPIO_STREAM_MAX_PORTS 3U
+
+typedef void (*hal_gpio_stream_callback_t)();
+
+/* Plays 'frame' into the set and clear registers (PSOR, PCOR) of 'ports'
+ * without the CPU: CTIMER3 raises one DMA request every 'slot_ticks' timer
+ * ticks and EDMA writes the pair frame[2 * (p * slots + s)], frame[2 * (p *
+ * slots + s) + 1] to PSOR then PCOR of port p in slot s. Every write sets a
+ * level, so a slot played from the wrong frame cannot outlast it. The frame
+ * repeats every 'slots' requests until another one is queued. */
+void hal_gpio_stream_start(const uint8_t *ports, uint32_t port_count, const uint32_t *frame, uint32_t slots,
+                           uint32_t slot_ticks);
+
+/* Plays 'frame' from the next pass on. 'started' runs from the DMA interrupt
+ * once it has replaced the previous frame, which is then free to rewrite.
+ * Only one frame may be queued; no interrupt fires while none is. */
+void hal_gpio_stream_next(const uint32_t *frame, hal_gpio_stream_callback_t started);
+
+/* Stops the stream in the middle of a pass, the pins keep their last state */
+void hal_gpio_stream_stop();
+
+/* --- ADC --- */
+
+/* Runs one blocking conversion on the given CMDL channel and returns the 16-bit result.
+ * Only valid while the scan below is stopped (e.g. at boot). */
+uint16_t hal_adc_read(uint8_t channel);
+
+/* Runs 'count' back-to-back conversions of one channel, CMD1 looping over it
+ * up to HAL_ADC_BURST_LOOPS times per software trigger so the results queue in
+ * FIFO0 instead of costing a trigger each. Same restriction as hal_adc_read(). */
+#define HAL_ADC_BURST_LOOPS 16U
+
+void hal_adc_burst(uint8_t channel, uint16_t *out, uint32_t count);
+
+/* RESFIFO word fields */
+#define HAL_ADC_RESULT_VALUE(word) ((uint16_t)((word) & 0xFFFFU))
+#define HAL_ADC_RESULT_CMD(word)   (((word) >> 24) & 0x0FU)  // 1-based command number
+
+/* 'trigger' is hal_ticks() at the trigger edge that started the scan, latched by the timer hardware */
+typedef void (*hal_adc_scan_callback_t)(const uint32_t *results, uint32_t count, uint32_t trigger);
+
+#define HAL_ADC_SCAN_MAX_SCANS 8U  // Ring slots
+
+typedef struct {
+    uint8_t channel;    // CMDL value
+    uint8_t averaging;  // 2^averaging conversions averaged in hardware (AVGS, 0..7)
+} hal_adc_scan_channel_t;
+
+/* Chains one LPADC command per channel (CMD1..CMDn, hardware averaging). CTIMER1
+ * match 3 starts the chain every 'period' timer ticks through INPUTMUX, the
+ * first edge half a period after the call, so the sample instants do not
+ * depend on the CPU. EDMA moves each scan from the FIFO into the next slot of
+ * 'ring' ('ring_scans' slots of 'count' words, wrapping in hardware) together
+ * with its trigger capture. 'done' runs from the DMA interrupt once per scan,
+ * in order, including the scans that completed while it was held off. */
+void hal_adc_scan_start(const hal_adc_scan_channel_t *channels, uint32_t count, uint32_t *ring, uint32_t ring_scans,
+                        uint32_t period, hal_adc_scan_callback_t done);
+
+void hal_adc_scan_stop();
+
+/* --- TRNG --- */
+
+/* Fills 'out' with words from the hardware true random number generator.
+ * Returns false, leaving 'out' untouched, when the part has none. */
+bool hal_trng_read(uint32_t *out, uint32_t count);
+
+/* --- CTIMER0 --- */
+
+/* Loads the match 0 configuration with a new period (in timer ticks).
+ * Only the software timer tick (swtimer.c) owns CTIMER0. */
+void hal_timer_set_period(uint32_t ticks);
+
+void hal_timer_start();
+
+/* Resets the counter and stops the timer */
+void hal_timer_stop();
+
+/* --- OLED I2C (LPI2C2 + EDMA) --- */
+
+#define HAL_OLED_I2C_ADDRESS 0x3CU
+
+typedef void (*hal_i2c_callback_t)();
+
+/* Attaches the EDMA channels to LPI2C2, called once the OLED driver has initialized the bus */
+void hal_i2c_init();
+
+/* Starts a background write of control byte + payload; 'done' runs from the completion interrupt.
+ * The payload must stay valid until then and only one transfer may be in flight. */
+void hal_i2c_write_async(uint8_t control, const uint8_t *data, uint32_t len, hal_i2c_callback_t done);
+
+/* --- DEBUG UART (LPUART + EDMA) --- */
+
+typedef void (*hal_uart_callback_t)();
+
+/* Attaches an EDMA channel to the transmitter of the debug console UART,
+ * called once BOARD_InitDebugConsole() has set the UART up */
+void hal_uart_init();
+
+/* Starts a background write; 'done' runs from the completion interrupt.
+ * The data must stay valid until then and only one write may be in flight. */
+void hal_uart_write_async(const uint8_t *data, uint32_t len, hal_uart_callback_t done);
+
+/* Takes one received byte if there is one, without waiting */
+bool hal_uart_read(uint8_t *byte);
+
+/* --- INTERRUPTS --- */
+
+/* Short critical sections shared with interrupt handlers. Sections nest and
+ * may be entered from a handler: interrupts are unmasked again by the
+ * outermost hal_irq_enable(), and only if they were enabled when it began. */
+void hal_irq_disable();
+
+void hal_irq_enable();
+
+/* --- IDLE --- */
+
+/* Sleeps (WFI) until an interrupt is pending. Called with interrupts disabled:
+ * a flag checked just before cannot be set unseen, the handler runs once the
+ * caller enables interrupts again. */
+void hal_sleep();
+
+/* Called from every polling loop: sleeps until the next interrupt, so a
+ * condition the loop checks without masking is seen at most one interrupt late */
+void hal_idle();
+
+/* Timer match callback, implemented by the application */
+void ctimer_match_callback(uint32_t flags);
+
+#endif /* HAL_H_ */
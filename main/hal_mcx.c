@@ -0,0 +1,437 @@
+#ifndef HOST_SIM
+
+#include "hal.h"
+#include "trace.h"
+#include "fsl_edma.h"
+#include "fsl_lpi2c_edma.h"
+#include "fsl_inputmux.h"
+#include "fsl_lpuart_edma.h"
+#if defined(FSL_FEATURE_SOC_TRNG_COUNT) && FSL_FEATURE_SOC_TRNG_COUNT
+#include "fsl_trng.h"
+#define HAL_HAS_TRNG 1
+#endif
+
+/* Board backend: forwards the HAL to the MCXN947 SDK drivers */
+
+static GPIO_Type *const hal_ports[HAL_PORT_COUNT] = {GPIO0, GPIO1, GPIO2, GPIO3, GPIO4};
+
+#define HAL_OLED_DMA_TX_CHANNEL 0U
+#define HAL_OLED_DMA_RX_CHANNEL 1U
+#define HAL_ADC_DMA_CHANNEL     2U
+#define HAL_ADC_STAMP_DMA_CHANNEL 3U  // Linked from the ADC channel, no request of its own
+#define HAL_STREAM_DMA_CHANNEL  4U  // First of one linked channel per streamed port
+#define HAL_UART_DMA_CHANNEL    (HAL_STREAM_DMA_CHANNEL + HAL_GPIO_STREAM_MAX_PORTS)
+
+#define HAL_UART ((LPUART_Type*)BOARD_DEBUG_UART_BASEADDR) // FLEXCOMM4 on the FRDM board
+
+#define HAL_ADC_TRIGGER_MATCH   kCTIMER_Match_3 // CTIMER1 MAT3 is an LPADC0 trigger input
+#define HAL_ADC_TRIGGER_CAPTURE kCTIMER_Capture_0 // CTIMER2 CAP0 latches hal_ticks() at each MAT3 edge
+
+lpadc_conv_result_t result;
+ctimer_match_config_t matchConfig;
+
+static edma_handle_t i2c_tx_dma;
+static edma_handle_t i2c_rx_dma;
+static lpi2c_master_edma_handle_t i2c_edma_handle;
+static lpi2c_master_transfer_t i2c_transfer;
+static hal_i2c_callback_t i2c_done;
+
+static edma_handle_t uart_tx_dma;
+static lpuart_edma_handle_t uart_edma_handle;
+static hal_uart_callback_t uart_done;
+
+static uint32_t last_ticks;  // hal_ticks() at the end of the last hal_sleep()
+
+static edma_handle_t adc_dma;
+SDK_ALIGN(static edma_tcd_t scan_tcds[HAL_ADC_SCAN_MAX_SCANS], 32); // One per ring slot, linked in a circle
+static uint32_t scan_stamps[HAL_ADC_SCAN_MAX_SCANS];                // Trigger capture of each slot
+static uint32_t *scan_ring;
+static uint32_t scan_count;
+static uint32_t scan_ring_scans;
+static uint32_t scan_slot;  // Next slot to hand to 'scan_done'
+static hal_adc_scan_callback_t scan_done;
+
+static edma_handle_t stream_dma;  // Last channel of the chain, its major loop ends each pass
+static uint32_t stream_ports;
+static uint32_t stream_slots;
+static const uint32_t *volatile stream_pending;
+static hal_gpio_stream_callback_t stream_started;
+
+void hal_init(){
+    /* DMA0 serves the OLED bus and the ADC scan */
+    edma_config_t config;
+    EDMA_GetDefaultConfig(&config);
+    EDMA_Init(DMA0, &config);
+
+    /* CTIMER2 free-runs as the hal_ticks() timebase: unlike the DWT cycle
+     * counter it keeps counting while the core is stopped in WFI */
+    CLOCK_SetClkDiv(kCLOCK_DivCtimer2Clk, 1u);
+    CLOCK_AttachClk(kPLL0_to_CTIMER2);
+    ctimer_config_t timer_config;
+    CTIMER_GetDefaultConfig(&timer_config);
+    CTIMER_Init(CTIMER2, &timer_config);
+    CTIMER_StartTimer(CTIMER2);
+    last_ticks = hal_ticks();
+}
+
+uint32_t hal_ticks(){
+    return CTIMER2->TC;
+}
+
+uint8_t hal_gpio_read(uint8_t port, uint32_t pin){
+    hal_stats[hal_module].gpio_reads++;
+    return (uint8_t)GPIO_PinRead(hal_ports[port], pin);
+}
+
+void hal_gpio_write(uint8_t port, uint32_t pin, uint8_t value){
+    hal_stats[hal_module].gpio_writes++;
+    GPIO_PinWrite(hal_ports[port], pin, value);
+}
+
+uint32_t hal_gpio_port_read(uint8_t port){
+    hal_stats[hal_module].gpio_reads++;
+    return hal_ports[port]->PDIR;
+}
+
+void hal_gpio_edge_irq(uint8_t port, uint32_t pin, bool enable){
+    GPIO_SetPinInterruptChannel(hal_ports[port], pin, kGPIO_InterruptOutput0);
+    GPIO_SetPinInterruptConfig(hal_ports[port], pin,
+                               enable ? kGPIO_InterruptEitherEdge : kGPIO_InterruptStatusFlagDisabled);
+}
+
+void hal_gpio_port_toggle(uint8_t port, uint32_t mask){
+    hal_stats[hal_module].gpio_writes++;
+    GPIO_PortToggle(hal_ports[port], mask);
+}
+
+void hal_gpio_port_clear(uint8_t port, uint32_t mask){
+    hal_stats[hal_module].gpio_writes++;
+    GPIO_PortClear(hal_ports[port], mask);
+}
+
+/* End of a pass: swap in the queued frame before the next slot request. A
+ * request served before the last channel is repointed plays one slot of the
+ * previous frame; the writes are absolute, so that lasts a single slot. */
+static void hal_gpio_stream_dma_callback(edma_handle_t *handle, void *param, bool transferDone, uint32_t tcds){
+    const uint32_t *frame = stream_pending;
+    if(!frame) return;
+    for(uint32_t p = 0; p < stream_ports; p++){
+        DMA0->CH[HAL_STREAM_DMA_CHANNEL + p].TCD_SADDR = (uint32_t)&frame[p * stream_slots * 2U];
+    }
+    stream_pending = NULL;
+    EDMA_DisableChannelInterrupts(DMA0, HAL_STREAM_DMA_CHANNEL + stream_ports - 1U, kEDMA_MajorInterruptEnable);
+    if(stream_started) stream_started();
+}
+
+void hal_gpio_stream_start(const uint8_t *ports, uint32_t port_count, const uint32_t *frame, uint32_t slots,
+                           uint32_t slot_ticks){
+    stream_ports = port_count;
+    stream_slots = slots;
+    stream_pending = NULL;
+
+    /* Channel p plays the words of port p, one set/clear pair per slot: the
+     * minor loop writes PSOR then the adjacent PCOR and steps the destination
+     * back to PSOR. The first channel answers the timer request and links to
+     * the next after every minor loop. */
+    edma_minor_offset_config_t rewind = {
+        .enableSrcMinorOffset = false,
+        .enableDestMinorOffset = true,
+        .minorOffset = (uint32_t)-(int32_t)(2U * sizeof(uint32_t)),
+    };
+    for(uint32_t p = 0; p < port_count; p++){
+        uint32_t channel = HAL_STREAM_DMA_CHANNEL + p;
+        edma_transfer_config_t config;
+        EDMA_PrepareTransferConfig(&config, (void*)&frame[p * slots * 2U], sizeof(uint32_t), sizeof(uint32_t),
+                                   (void*)&hal_ports[ports[p]]->PSOR, sizeof(uint32_t), sizeof(uint32_t),
+                                   2U * sizeof(uint32_t), slots * 2U * sizeof(uint32_t));
+        EDMA_SetTransferConfig(DMA0, channel, &config, NULL);
+        EDMA_SetMinorOffsetConfig(DMA0, channel, &rewind);
+        /* The last minor loop takes the major offsets instead of the minor one */
+        EDMA_SetMajorOffsetConfig(DMA0, channel, -(int32_t)(slots * 2U * sizeof(uint32_t)),
+                                  -(int32_t)(2U * sizeof(uint32_t)));
+        EDMA_EnableAutoStopRequest(DMA0, channel, false); // Wrap to the frame start and keep going
+        if(p + 1U < port_count){
+            EDMA_SetChannelLink(DMA0, channel, kEDMA_MinorLink, channel + 1U);
+            EDMA_SetChannelLink(DMA0, channel, kEDMA_MajorLink, channel + 1U);
+        }
+    }
+    EDMA_CreateHandle(&stream_dma, DMA0, HAL_STREAM_DMA_CHANNEL + port_count - 1U);
+    EDMA_SetCallback(&stream_dma, hal_gpio_stream_dma_callback, NULL);
+    EDMA_SetChannelMux(DMA0, HAL_STREAM_DMA_CHANNEL, kDma0RequestMuxCtimer3M0);
+    EDMA_EnableChannelRequest(DMA0, HAL_STREAM_DMA_CHANNEL);
+
+    /* CTIMER3 match 0 requests one slot per period */
+    CLOCK_SetClkDiv(kCLOCK_DivCtimer3Clk, 1u);
+    CLOCK_AttachClk(kPLL0_to_CTIMER3);
+    ctimer_config_t timer_config;
+    CTIMER_GetDefaultConfig(&timer_config);
+    CTIMER_Init(CTIMER3, &timer_config);
+    ctimer_match_config_t slot = {
+        .matchValue = slot_ticks - 1U,
+        .enableCounterReset = true,
+        .enableCounterStop = false,
+        .outControl = kCTIMER_Output_NoAction,
+        .outPinInitState = false,
+        .enableInterrupt = false,
+    };
+    CTIMER_SetupMatch(CTIMER3, kCTIMER_Match_0, &slot);
+    CTIMER_StartTimer(CTIMER3);
+}
+
+void hal_gpio_stream_next(const uint32_t *frame, hal_gpio_stream_callback_t started){
+    stream_started = started;
+    stream_pending = frame;
+    EDMA_EnableChannelInterrupts(DMA0, HAL_STREAM_DMA_CHANNEL + stream_ports - 1U, kEDMA_MajorInterruptEnable);
+}
+
+void hal_gpio_stream_stop(){
+    CTIMER_StopTimer(CTIMER3);
+    EDMA_AbortTransfer(&stream_dma);
+    for(uint32_t p = 0; p < stream_ports; p++){
+        EDMA_DisableChannelRequest(DMA0, HAL_STREAM_DMA_CHANNEL + p);
+    }
+    stream_pending = NULL;
+}
+
+uint16_t hal_adc_read(uint8_t channel){
+    TRACE_BEGIN(TRACE_ADC_READ);
+    hal_stats[hal_module].adc_conversions++;
+    ADC0->CMD->CMDL = channel;
+    LPADC_DoSoftwareTrigger(ADC0, 1);
+    LPADC_GetConvResultBlocking(ADC0, &result, 0);
+    TRACE_END(TRACE_ADC_READ);
+    return result.convValue;
+}
+
+void hal_adc_burst(uint8_t channel, uint16_t *out, uint32_t count){
+    uint32_t cmdh = ADC0->CMD[0].CMDH;
+    ADC0->CMD[0].CMDL = channel;
+    for(uint32_t done = 0; done < count;){
+        uint32_t loops = count - done;
+        if(loops > HAL_ADC_BURST_LOOPS) loops = HAL_ADC_BURST_LOOPS;
+        ADC0->CMD[0].CMDH = (cmdh & ~ADC_CMDH_LOOP_MASK) | ADC_CMDH_LOOP(loops - 1U);
+        LPADC_DoSoftwareTrigger(ADC0, 1);
+        /* The loop runs on its own, each result is taken as soon as it lands */
+        for(uint32_t i = 0; i < loops; i++){
+            LPADC_GetConvResultBlocking(ADC0, &result, 0);
+            out[done + i] = result.convValue;
+        }
+        done += loops;
+    }
+    ADC0->CMD[0].CMDH = cmdh;
+    hal_stats[hal_module].adc_conversions += count;
+}
+
+/* Scan DMA interrupt: hands over every slot whose stamp has landed, in
+ * order, so an interrupt served late still delivers each scan with its own
+ * trigger time (up to ring_scans - 1 scans late) */
+static void hal_adc_scan_dma_callback(edma_handle_t *handle, void *param, bool transferDone, uint32_t tcds){
+    uint32_t filled = (DMA0->CH[HAL_ADC_STAMP_DMA_CHANNEL].TCD_DADDR - (uint32_t)scan_stamps) / sizeof(uint32_t);
+    while(scan_slot != filled){
+        hal_stats[hal_module].adc_conversions += scan_count;
+        if(scan_done) scan_done(&scan_ring[scan_slot * scan_count], scan_count, scan_stamps[scan_slot]);
+        scan_slot = (scan_slot + 1U) % scan_ring_scans;
+    }
+}
+
+/* CTIMER1 toggles MAT3 every half period: one rising edge, and one scan, per
+ * period, the first half a period after the start. CTIMER2 captures each
+ * rising edge, so the stamps are on the hal_ticks() timebase. */
+static void hal_adc_trigger_start(uint32_t period){
+    CLOCK_SetClkDiv(kCLOCK_DivCtimer1Clk, 1u);
+    CLOCK_AttachClk(kPLL0_to_CTIMER1); // Same 150 MHz clock as CTIMER0 and CTIMER2
+
+    ctimer_config_t config;
+    CTIMER_GetDefaultConfig(&config);
+    CTIMER_Init(CTIMER1, &config);
+
+    ctimer_match_config_t trigger = {
+        .matchValue = period / 2U - 1U,
+        .enableCounterReset = true,
+        .enableCounterStop = false,
+        .outControl = kCTIMER_Output_Toggle,
+        .outPinInitState = false,
+        .enableInterrupt = false,
+    };
+    CTIMER_SetupMatch(CTIMER1, HAL_ADC_TRIGGER_MATCH, &trigger);
+
+    INPUTMUX_Init(INPUTMUX0);
+    INPUTMUX_AttachSignal(INPUTMUX0, 0U, kINPUTMUX_Ctimer1M3ToAdc0Trigger);
+    INPUTMUX_AttachSignal(INPUTMUX0, 0U, kINPUTMUX_Ctimer1M3ToTimer2Captsel);
+    CTIMER_SetupCapture(CTIMER2, HAL_ADC_TRIGGER_CAPTURE, kCTIMER_Capture_RiseEdge, false);
+
+    /* Trigger 0 starts CMD1 on each hardware edge */
+    ADC0->TCTRL[0] = (ADC0->TCTRL[0] & ~ADC_TCTRL_TCMD_MASK) | ADC_TCTRL_TCMD(1) | ADC_TCTRL_HTEN_MASK;
+    CTIMER_StartTimer(CTIMER1);
+}
+
+void hal_adc_scan_start(const hal_adc_scan_channel_t *channels, uint32_t count, uint32_t *ring, uint32_t ring_scans,
+                        uint32_t period, hal_adc_scan_callback_t done){
+    scan_ring = ring;
+    scan_count = count;
+    scan_ring_scans = ring_scans;
+    scan_slot = 0;
+    scan_done = done;
+
+    /* CMD1 -> CMD2 -> ... -> CMDn, once per trigger, keeping the CMD1 settings from the config tools */
+    uint32_t cmdh = ADC0->CMD[0].CMDH & ~(ADC_CMDH_NEXT_MASK | ADC_CMDH_AVGS_MASK);
+    for(uint32_t i = 0; i < count; i++){
+        uint32_t next = (i + 1U < count) ? i + 2U : 0U;
+        ADC0->CMD[i].CMDL = channels[i].channel;
+        ADC0->CMD[i].CMDH = cmdh | ADC_CMDH_AVGS(channels[i].averaging) | ADC_CMDH_NEXT(next);
+    }
+
+    /* One DMA request per full scan in FIFO0 */
+    ADC0->FCTRL[0] = (ADC0->FCTRL[0] & ~ADC_FCTRL_FWMARK_MASK) | ADC_FCTRL_FWMARK(count - 1U);
+    ADC0->DE |= ADC_DE_FWMDE0_MASK;
+
+    /* The stamp channel copies the capture of the edge that started the scan
+     * into its slot of scan_stamps, once per completed scan, and wraps */
+    edma_transfer_config_t config;
+    EDMA_PrepareTransferConfig(&config, (void*)&CTIMER2->CR[HAL_ADC_TRIGGER_CAPTURE], sizeof(uint32_t), 0,
+                               scan_stamps, sizeof(uint32_t), sizeof(uint32_t),
+                               sizeof(uint32_t), ring_scans * sizeof(uint32_t));
+    EDMA_SetTransferConfig(DMA0, HAL_ADC_STAMP_DMA_CHANNEL, &config, NULL);
+    EDMA_SetMajorOffsetConfig(DMA0, HAL_ADC_STAMP_DMA_CHANNEL, 0, -(int32_t)(ring_scans * sizeof(uint32_t)));
+    EDMA_EnableAutoStopRequest(DMA0, HAL_ADC_STAMP_DMA_CHANNEL, false);
+
+    /* Each slot is one major loop moving a whole scan; its TCD loads the next
+     * slot's, interrupts and links to the stamp channel, so the ring keeps
+     * filling without the CPU */
+    for(uint32_t i = 0; i < ring_scans; i++){
+        EDMA_PrepareTransferConfig(&config, (void*)&ADC0->RESFIFO[0], sizeof(uint32_t), 0,
+                                   &ring[i * count], sizeof(uint32_t), sizeof(uint32_t),
+                                   count * sizeof(uint32_t), count * sizeof(uint32_t));
+        EDMA_TcdReset(&scan_tcds[i]);
+        EDMA_TcdSetTransferConfig(&scan_tcds[i], &config, &scan_tcds[(i + 1U) % ring_scans]);
+        EDMA_TcdSetChannelLink(&scan_tcds[i], kEDMA_MajorLink, HAL_ADC_STAMP_DMA_CHANNEL);
+        EDMA_TcdEnableInterrupts(&scan_tcds[i], kEDMA_MajorInterruptEnable);
+    }
+    EDMA_SetChannelMux(DMA0, HAL_ADC_DMA_CHANNEL, kDma0RequestMuxAdc0FifoARequest);
+    EDMA_CreateHandle(&adc_dma, DMA0, HAL_ADC_DMA_CHANNEL);
+    EDMA_SetCallback(&adc_dma, hal_adc_scan_dma_callback, NULL);
+    EDMA_InstallTCD(DMA0, HAL_ADC_DMA_CHANNEL, &scan_tcds[0]);
+    EDMA_EnableChannelRequest(DMA0, HAL_ADC_DMA_CHANNEL);
+
+    hal_adc_trigger_start(period);
+}
+
+void hal_adc_scan_stop(){
+    CTIMER_StopTimer(CTIMER1);
+    ADC0->TCTRL[0] &= ~ADC_TCTRL_HTEN_MASK; // Back to software triggers for hal_adc_read()
+    EDMA_AbortTransfer(&adc_dma);
+    ADC0->DE &= ~ADC_DE_FWMDE0_MASK;
+
+    /* Break the chain and drop whatever is still in flight */
+    LPADC_Enable(ADC0, false);
+    ADC0->CMD[0].CMDH &= ~(ADC_CMDH_NEXT_MASK | ADC_CMDH_AVGS_MASK);
+    LPADC_DoResetFIFO0(ADC0);
+    LPADC_Enable(ADC0, true);
+}
+
+bool hal_trng_read(uint32_t *out, uint32_t count){
+#ifdef HAL_HAS_TRNG
+    static bool ready = 0;
+    if(!ready){
+        trng_config_t config;
+        TRNG_GetDefaultConfig(&config);
+        if(TRNG_Init(TRNG, &config) != kStatus_Success) return 0;
+        ready = 1;
+    }
+    return TRNG_GetRandomData(TRNG, out, count * sizeof(uint32_t)) == kStatus_Success;
+#else
+    return 0;
+#endif
+}
+
+void hal_timer_set_period(uint32_t ticks){
+    matchConfig = CTIMER0_Match_0_config;
+    matchConfig.matchValue = ticks;
+    CTIMER_SetupMatch(CTIMER0_PERIPHERAL, CTIMER0_MATCH_0_CHANNEL, &matchConfig);
+}
+
+void hal_timer_start(){
+    CTIMER_StartTimer(CTIMER0_PERIPHERAL);
+}
+
+void hal_timer_stop(){
+    CTIMER_Reset(CTIMER0);
+    CTIMER_StopTimer(CTIMER0);
+}
+
+static void hal_i2c_edma_callback(LPI2C_Type *base, lpi2c_master_edma_handle_t *handle, status_t status, void *userData){
+    if(i2c_done) i2c_done();
+}
+
+void hal_i2c_init(){
+    EDMA_SetChannelMux(DMA0, HAL_OLED_DMA_TX_CHANNEL, kDma0RequestMuxLpFlexcomm2Tx);
+    EDMA_SetChannelMux(DMA0, HAL_OLED_DMA_RX_CHANNEL, kDma0RequestMuxLpFlexcomm2Rx);
+    EDMA_CreateHandle(&i2c_tx_dma, DMA0, HAL_OLED_DMA_TX_CHANNEL);
+    EDMA_CreateHandle(&i2c_rx_dma, DMA0, HAL_OLED_DMA_RX_CHANNEL);
+    LPI2C_MasterCreateEDMAHandle(LPI2C2, &i2c_edma_handle, &i2c_rx_dma, &i2c_tx_dma, hal_i2c_edma_callback, NULL);
+}
+
+void hal_i2c_write_async(uint8_t control, const uint8_t *data, uint32_t len, hal_i2c_callback_t done){
+    hal_stats[hal_module].i2c_bytes += len + 2U; // Address and control bytes
+    i2c_done = done;
+    i2c_transfer.slaveAddress = HAL_OLED_I2C_ADDRESS;
+    i2c_transfer.direction = kLPI2C_Write;
+    i2c_transfer.subaddress = control;
+    i2c_transfer.subaddressSize = 1;
+    i2c_transfer.data = (void*)data;
+    i2c_transfer.dataSize = len;
+    i2c_transfer.flags = kLPI2C_TransferDefaultFlag;
+    LPI2C_MasterTransferEDMA(LPI2C2, &i2c_edma_handle, &i2c_transfer);
+}
+
+static void hal_uart_edma_callback(LPUART_Type *base, lpuart_edma_handle_t *handle, status_t status, void *userData){
+    if(uart_done) uart_done();
+}
+
+void hal_uart_init(){
+    EDMA_SetChannelMux(DMA0, HAL_UART_DMA_CHANNEL, kDma0RequestMuxLpFlexcomm4Tx);
+    EDMA_CreateHandle(&uart_tx_dma, DMA0, HAL_UART_DMA_CHANNEL);
+    LPUART_TransferCreateHandleEDMA(HAL_UART, &uart_edma_handle, hal_uart_edma_callback, NULL, &uart_tx_dma, NULL);
+}
+
+void hal_uart_write_async(const uint8_t *data, uint32_t len, hal_uart_callback_t done){
+    lpuart_transfer_t transfer = {.data = (uint8_t*)data, .dataSize = len};
+    uart_done = done;
+    LPUART_SendEDMA(HAL_UART, &uart_edma_handle, &transfer);
+}
+
+bool hal_uart_read(uint8_t *byte){
+    uint32_t flags = LPUART_GetStatusFlags(HAL_UART);
+    if(flags & kLPUART_RxOverrunFlag) LPUART_ClearStatusFlags(HAL_UART, kLPUART_RxOverrunFlag);
+    if(!(flags & kLPUART_RxDataRegFullFlag)) return false;
+    *byte = LPUART_ReadByte(HAL_UART);
+    return true;
+}
+
+void hal_sleep(){
+    uint32_t start = hal_ticks();
+    __DSB();
+    __WFI(); // Wakes on a pending interrupt even with PRIMASK set
+    uint32_t now = hal_ticks();
+    hal_stats[hal_module].cycles += now - last_ticks;
+    hal_stats[hal_module].idle_cycles += now - start;
+    hal_stats[hal_module].wakeups++;
+    last_ticks = now;
+}
+
+/* Nesting depth and the PRIMASK found by the outermost hal_irq_disable() */
+static uint32_t irq_depth = 0;
+static uint32_t irq_primask;
+
+void hal_irq_disable(){
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if(irq_depth++ == 0) irq_primask = primask;
+}
+
+void hal_irq_enable(){
+    /* Only the outermost section unmasks, and only if it found interrupts enabled */
+    if(--irq_depth == 0 && irq_primask == 0) __enable_irq();
+}
+
+#endif /* HOST_SIM */
@@ -0,0 +1,190 @@
+#include "hal.h"
+#include "history.h"
+
+/* Ring of points and the two deques of one tier. The deques hold ring slots,
+ * oldest first, whose min (max) values rise (fall) from front to back. */
+#define HISTORY_STORAGE(points) struct {  \
+        history_point_t point[points];    \
+        uint8_t min_queue[points];        \
+        uint8_t max_queue[points];        \
+    }
+
+typedef struct {
+    history_point_t *point;
+    uint8_t *min_queue;
+    uint8_t *max_queue;
+    uint8_t capacity;
+    uint8_t count;
+    uint8_t next;        // Slot of the next point
+    uint8_t min_first;
+    uint8_t min_len;
+    uint8_t max_first;
+    uint8_t max_len;
+    uint16_t factor;     // Inputs per point
+    uint16_t bucket_n;   // Inputs in the point being built
+    uint16_t bucket_min;
+    uint16_t bucket_max;
+    uint32_t bucket_sum;
+    uint32_t sum;        // Of the point means in the ring
+    uint64_t sum_sq;
+    uint32_t total;
+} history_ring_t;
+
+static HISTORY_STORAGE(HISTORY_MINUTE_POINTS) minute_storage[HISTORY_SENSORS];
+static HISTORY_STORAGE(HISTORY_HOUR_POINTS) hour_storage[HISTORY_SENSORS];
+static HISTORY_STORAGE(HISTORY_DAY_POINTS) day_storage[HISTORY_SENSORS];
+
+static history_ring_t rings[HISTORY_SENSORS][HISTORY_TIERS];
+
+#define HISTORY_STR_(x) #x
+#define HISTORY_STR(x)  HISTORY_STR_(x)
+
+_Static_assert(sizeof(minute_storage[0]) == HISTORY_MINUTE_BYTES, "update HISTORY_MINUTE_BYTES");
+_Static_assert(sizeof(hour_storage[0]) == HISTORY_HOUR_BYTES, "update HISTORY_HOUR_BYTES");
+_Static_assert(sizeof(day_storage[0]) == HISTORY_DAY_BYTES, "update HISTORY_DAY_BYTES");
+_Static_assert(HISTORY_MINUTE_POINTS <= 255U && HISTORY_HOUR_POINTS <= 255U && HISTORY_DAY_POINTS <= 255U,
+               "deques hold 8-bit slots");
+_Static_assert((uint64_t)HISTORY_MINUTE_SCANS * 0xFFFFU <= UINT32_MAX, "bucket sum overflows");
+
+#pragma message("history: minute tier " HISTORY_STR(HISTORY_MINUTE_BYTES) " B, hour tier " \
+                HISTORY_STR(HISTORY_HOUR_BYTES) " B, day tier " HISTORY_STR(HISTORY_DAY_BYTES) " B per sensor")
+
+static void history_ring_init(history_ring_t *ring, history_point_t *point, uint8_t *min_queue, uint8_t *max_queue,
+                              uint8_t capacity, uint16_t factor){
+    *ring = (history_ring_t){0};
+    ring->point = point;
+    ring->min_queue = min_queue;
+    ring->max_queue = max_queue;
+    ring->capacity = capacity;
+    ring->factor = factor;
+}
+
+void history_reset(){
+    hal_irq_disable();
+    for(uint32_t s = 0; s < HISTORY_SENSORS; s++){
+        history_ring_init(&rings[s][HISTORY_MINUTE], minute_storage[s].point, minute_storage[s].min_queue,
+                          minute_storage[s].max_queue, HISTORY_MINUTE_POINTS, HISTORY_MINUTE_SCANS);
+        history_ring_init(&rings[s][HISTORY_HOUR], hour_storage[s].point, hour_storage[s].min_queue,
+                          hour_storage[s].max_queue, HISTORY_HOUR_POINTS, HISTORY_HOUR_FACTOR);
+        history_ring_init(&rings[s][HISTORY_DAY], day_storage[s].point, day_storage[s].min_queue,
+                          day_storage[s].max_queue, HISTORY_DAY_POINTS, HISTORY_DAY_FACTOR);
+    }
+    hal_irq_enable();
+}
+
+static uint8_t history_slot(const history_ring_t *ring, uint32_t index){
+    return (uint8_t)(index < ring->capacity ? index : index - ring->capacity);
+}
+
+/* Appends a point, dropping the oldest one of a full ring */
+static void history_push(history_ring_t *ring, history_point_t point){
+    uint8_t slot = ring->next;
+
+    if(ring->count == ring->capacity){
+        history_point_t old = ring->point[slot];
+        ring->sum -= old.mean;
+        ring->sum_sq -= (uint32_t)old.mean * old.mean;
+        /* The overwritten slot can only sit at the front of a deque */
+        if(ring->min_len && ring->min_queue[ring->min_first] == slot){
+            ring->min_first = history_slot(ring, ring->min_first + 1U);
+            ring->min_len--;
+        }
+        if(ring->max_len && ring->max_queue[ring->max_first] == slot){
+            ring->max_first = history_slot(ring, ring->max_first + 1U);
+            ring->max_len--;
+        }
+    } else {
+        ring->count++;
+    }
+
+    ring->point[slot] = point;
+    ring->sum += point.mean;
+    ring->sum_sq += (uint32_t)point.mean * point.mean;
+    ring->next = history_slot(ring, slot + 1U);
+    ring->total++;
+
+    /* Older slots that can no longer be the extreme leave from the back */
+    while(ring->min_len &&
+          ring->point[ring->min_queue[history_slot(ring, ring->min_first + ring->min_len - 1U)]].min >= point.min){
+        ring->min_len--;
+    }
+    ring->min_queue[history_slot(ring, ring->min_first + ring->min_len)] = slot;
+    ring->min_len++;
+
+    while(ring->max_len &&
+          ring->point[ring->max_queue[history_slot(ring, ring->max_first + ring->max_len - 1U)]].max <= point.max){
+        ring->max_len--;
+    }
+    ring->max_queue[history_slot(ring, ring->max_first + ring->max_len)] = slot;
+    ring->max_len++;
+}
+
+/* Adds one input to the point being built; returns 1 with the point once it has 'factor' inputs */
+static bool history_bucket(history_ring_t *ring, history_point_t in, history_point_t *out){
+    if(ring->bucket_n == 0){
+        ring->bucket_min = in.min;
+        ring->bucket_max = in.max;
+    } else {
+        if(in.min < ring->bucket_min) ring->bucket_min = in.min;
+        if(in.max > ring->bucket_max) ring->bucket_max = in.max;
+    }
+    ring->bucket_sum += in.mean;
+    if(++ring->bucket_n < ring->factor) return 0;
+
+    out->mean = (uint16_t)((ring->bucket_sum + ring->factor / 2U) / ring->factor);
+    out->min = ring->bucket_min;
+    out->max = ring->bucket_max;
+    ring->bucket_n = 0;
+    ring->bucket_sum = 0;
+    return 1;
+}
+
+void history_add(adc_scan_channel_t sensor, uint16_t value){
+    if(sensor >= HISTORY_SENSORS) return;
+    history_point_t point = {value, value, value};
+    for(uint32_t t = 0; t < HISTORY_TIERS; t++){
+        history_ring_t *ring = &rings[sensor][t];
+        if(!history_bucket(ring, point, &point)) break;
+        history_push(ring, point);
+    }
+}
+
+history_stats_t history_stats(adc_scan_channel_t sensor, history_tier_t tier){
+    history_stats_t stats = {0};
+    const history_ring_t *ring = &rings[sensor][tier];
+
+    hal_irq_disable();
+    uint32_t n = ring->count;
+    uint32_t sum = ring->sum;
+    uint64_t sum_sq = ring->sum_sq;
+    if(n > 0){
+        stats.min = ring->point[ring->min_queue[ring->min_first]].min;
+        stats.max = ring->point[ring->max_queue[ring->max_first]].max;
+    }
+    hal_irq_enable();
+
+    if(n > 0){
+        stats.count = n;
+        stats.mean = (uint16_t)((sum + n / 2U) / n);
+        stats.variance = (uint32_t)((n * sum_sq - (uint64_t)sum * sum) / ((uint64_t)n * n));
+    }
+    return stats;
+}
+
+uint32_t history_points(adc_scan_channel_t sensor, history_tier_t tier, history_point_t *out, uint32_t count){
+    const history_ring_t *ring = &rings[sensor][tier];
+
+    hal_irq_disable();
+    if(count > ring->count) count = ring->count;
+    uint32_t slot = ring->next + ring->capacity - count; // Oldest of the newest 'count'
+    for(uint32_t i = 0; i < count; i++){
+        if(slot >= ring->capacity) slot -= ring->capacity;
+        out[i] = ring->point[slot++];
+    }
+    hal_irq_enable();
+    return count;
+}
+
+uint32_t history_total(adc_scan_channel_t sensor, history_tier_t tier){
+    return rings[sensor][tier].total;
+}
@@ -0,0 +1,72 @@
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include "hal.h"
+#include "adc_scan.h"
+
+/*
+ * SENSOR HISTORY
+ * Fixed-size, allocation-free time series of the thermistor and photodiode,
+ * fed with every filtered scan from the ADC interrupt. Three tiers keep
+ * downsampled points of the one below:
+ *  - minute: 60 points of 1 s (100 scans)
+ *  - hour:   60 points of 1 min
+ *  - day:    96 points of 15 min
+ * Each point holds the mean, min and max of the samples it covers, so the
+ * day tier still knows the extremes of single scans. Per tier, two monotonic
+ * deques of ring slots give the window min and max, and running sums the mean
+ * and variance: adding a point is amortized O(1) and every query is O(1).
+ * The window of a tier is its full ring, set by the macros below.
+ */
+
+#define HISTORY_SENSORS 2U  // ADC_SCAN_THERMISTOR and ADC_SCAN_PHOTODIODE
+
+#define HISTORY_MINUTE_POINTS 60U
+#define HISTORY_MINUTE_SCANS  100U  // Scans per point, 1 s of the 10 ms scan
+#define HISTORY_HOUR_POINTS   60U
+#define HISTORY_HOUR_FACTOR   60U   // Minute points per hour point
+#define HISTORY_DAY_POINTS    96U
+#define HISTORY_DAY_FACTOR    15U   // Hour points per day point
+
+/* Bytes per sensor and tier for the points and both deques, checked against
+ * the storage in history.c and printed by every build of it */
+#define HISTORY_MINUTE_BYTES 480
+#define HISTORY_HOUR_BYTES   480
+#define HISTORY_DAY_BYTES    768
+
+typedef enum {
+    HISTORY_MINUTE = 0,
+    HISTORY_HOUR,
+    HISTORY_DAY,
+    HISTORY_TIERS
+} history_tier_t;
+
+typedef struct {
+    uint16_t mean;
+    uint16_t min;
+    uint16_t max;
+} history_point_t;
+
+typedef struct {
+    uint32_t count;     // Points in the window, 0 = nothing yet
+    uint16_t min;       // Lowest scan in the window
+    uint16_t max;       // Highest scan in the window
+    uint16_t mean;      // Mean of the point means
+    uint32_t variance;  // Variance of the point means, in counts^2
+} history_stats_t;
+
+/* Empties every tier, called by adc_scan_start() */
+void history_reset();
+
+/* Adds one filtered scan of a sensor, from the ADC interrupt */
+void history_add(adc_scan_channel_t sensor, uint16_t value);
+
+history_stats_t history_stats(adc_scan_channel_t sensor, history_tier_t tier);
+
+/* Copies up to 'count' of the newest points, oldest first, and returns how many */
+uint32_t history_points(adc_scan_channel_t sensor, history_tier_t tier, history_point_t *out, uint32_t count);
+
+/* Points added to the tier since the reset, changes with every new point */
+uint32_t history_total(adc_scan_channel_t sensor, history_tier_t tier);
+
+#endif /* HISTORY_H_ */
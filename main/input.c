@@ -0,0 +1,239 @@
+#include <stdatomic.h>
+#include "hal.h"
+#include "swtimer.h"
+#include "pinbus.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "input.h"
+
+input_stats_t input_stats;
+
+/* One single-producer ring per posting context, so no producer ever waits
+ * for or masks another: the button IRQs share one NVIC priority, the
+ * sampling tick runs from the timer interrupt. */
+typedef struct {
+    input_event_t events[INPUT_RING_SIZE];
+    volatile uint32_t head;  // Written by the producer only
+    volatile uint32_t tail;  // Written by the consumer only
+} input_ring_t;
+
+static input_ring_t irq_ring;   // Button interrupt handlers
+static input_ring_t scan_ring;  // Sampling tick
+
+static input_event_t pending[INPUT_PENDING_SIZE];  // Presses drained but not taken, oldest first
+static uint32_t pending_count;
+
+/* NAV pins (active low), in input_button_t order from INPUT_NAV_LEFT */
+typedef struct {
+    uint8_t port;
+    uint8_t pin;
+} input_pin_t;
+
+static const input_pin_t nav_pins[INPUT_DIP1 - INPUT_NAV_LEFT] = {
+        {HAL_PORT3, SHIELD_NAV_A_LEFT_GPIO_PIN},
+        {HAL_PORT1, SHIELD_NAV_B_RIGHT_GPIO_PIN},
+        {HAL_PORT3, SHIELD_NAV_C_UP_GPIO_PIN},
+        {HAL_PORT0, SHIELD_NAV_D_DOWN_GPIO_PIN},
+};
+
+/* DIP1..DIP8 (on = 1) gathered from the same GPIO0 snapshot */
+PINBUS_DEFINE(dip_bus, HAL_PORT0,
+              SHIELD_DIP_1_GPIO_PIN, SHIELD_DIP_2_GPIO_PIN, SHIELD_DIP_3_GPIO_PIN, SHIELD_DIP_4_GPIO_PIN,
+              SHIELD_DIP_5_GPIO_PIN, SHIELD_DIP_6_GPIO_PIN, SHIELD_DIP_7_GPIO_PIN, SHIELD_DIP_8_GPIO_PIN);
+
+/* Ports holding sampled pins, read once per sample (GPIO0 for DIP and NAV down) */
+#define INPUT_PORTS ((1U << HAL_PORT0) | (1U << HAL_PORT1) | (1U << HAL_PORT3))
+
+static swtimer_t scan_timer;
+static uint32_t window = INPUT_DEBOUNCE_MS;
+static uint32_t history[INPUT_SAMPLED];  // Last samples of each pin, newest in bit 0
+static uint32_t first_edge[INPUT_SAMPLED];
+static uint32_t settled;                 // Debounced states, bit per sampled input
+static uint32_t changing;                // Inputs whose samples left the settled state
+static uint32_t last_press[INPUT_FIRST_SAMPLED];
+static uint32_t recent;                  // Interrupt buttons with a valid last_press
+
+/* Producer side of 'ring', from its one interrupt context */
+static void input_post_at(input_ring_t *ring, input_button_t button, input_edge_t edge, uint32_t tick){
+    uint32_t h = ring->head;
+    input_stats.posted++;
+    if(h - ring->tail == INPUT_RING_SIZE){
+        input_stats.overflows++;
+        return;
+    }
+    ring->events[h & (INPUT_RING_SIZE - 1U)] = (input_event_t){(uint8_t)button, (uint8_t)edge, tick};
+    atomic_signal_fence(memory_order_release); // Slot written before it is published
+    ring->head = h + 1U;
+    telemetry_input((uint8_t)button, (uint8_t)edge);
+}
+
+void input_post(input_button_t button, input_edge_t edge){
+    uint32_t now = hal_ticks();
+    if(button < INPUT_FIRST_SAMPLED && edge == INPUT_EDGE_PRESS){
+        /* Contact bounce raises the edge interrupt again right after the press */
+        if((recent & (1U << button)) && now - last_press[button] < window * INPUT_SAMPLE_MS * (HAL_TIMER_CLOCK_HZ / 1000U)){
+            input_stats.bounces++;
+            return;
+        }
+        last_press[button] = now;
+        recent |= 1U << button;
+    }
+    input_post_at(&irq_ring, button, edge, now);
+}
+
+/* Raw state of each sampled input from one read per port, bit per input */
+static uint32_t input_sample(){
+    uint32_t ports[HAL_PORT_COUNT] = {0};
+    for(uint32_t p = 0; p < HAL_PORT_COUNT; p++){
+        if(INPUT_PORTS & (1U << p)) ports[p] = hal_gpio_port_read((uint8_t)p);
+    }
+    uint32_t raw = (uint32_t)pinbus_gather(&dip_bus, ports[dip_bus.port]) << (INPUT_DIP1 - INPUT_FIRST_SAMPLED);
+    for(uint32_t i = 0; i < INPUT_DIP1 - INPUT_NAV_LEFT; i++){
+        raw |= (~ports[nav_pins[i].port] >> nav_pins[i].pin & 1U) << (INPUT_NAV_LEFT - INPUT_FIRST_SAMPLED + i);
+    }
+    return raw;
+}
+
+/* Sampling tick, from the software timer interrupt */
+static void input_scan(swtimer_t *timer){
+    TRACE_BEGIN(TRACE_INPUT_SCAN);
+    uint32_t now = hal_ticks();
+    uint32_t raw = input_sample();
+    uint32_t full = (window >= 32U) ? 0xFFFFFFFFU : (1U << window) - 1U;
+
+    for(uint32_t i = 0; i < INPUT_SAMPLED; i++){
+        uint32_t bit = 1U << i;
+        uint32_t level = (raw >> i) & 1U;
+        history[i] = (history[i] << 1) | level;
+
+        bool on = (settled & bit) != 0;
+        uint32_t agreed = history[i] & full;
+        if(level != on && !(changing & bit)){
+            changing |= bit;
+            first_edge[i] = now;
+        }
+        if(!(changing & bit)) continue;
+
+        if(agreed == (on ? 0U : full)){
+            settled ^= bit;
+            changing &= ~bit;
+            input_post_at(&scan_ring, (input_button_t)(INPUT_FIRST_SAMPLED + i),
+                          on ? INPUT_EDGE_RELEASE : INPUT_EDGE_PRESS, first_edge[i]);
+        } else if(agreed == (on ? full : 0U)){
+            changing &= ~bit; // A glitch that settled back
+            input_stats.bounces++;
+        }
+    }
+    TRACE_END(TRACE_INPUT_SCAN);
+}
+
+void input_scan_start(){
+    uint32_t raw = input_sample();
+    for(uint32_t i = 0; i < INPUT_SAMPLED; i++) history[i] = ((raw >> i) & 1U) ? 0xFFFFFFFFU : 0U;
+    settled = raw;
+    changing = 0;
+    recent = 0;
+    swtimer_start(&scan_timer, INPUT_SAMPLE_MS, INPUT_SAMPLE_MS, input_scan);
+}
+
+void input_scan_stop(){
+    swtimer_cancel(&scan_timer);
+}
+
+void input_set_debounce(uint32_t samples){
+    if(samples < 1U) samples = 1U;
+    if(samples > 32U) samples = 32U;
+    window = samples;
+}
+
+bool input_level(input_button_t button){
+    return (settled >> (button - INPUT_FIRST_SAMPLED)) & 1U;
+}
+
+uint8_t input_dip(){
+    return (uint8_t)(settled >> (INPUT_DIP1 - INPUT_FIRST_SAMPLED));
+}
+
+static void input_record_latency(uint32_t ticks){
+    uint32_t us = ticks / (HAL_TIMER_CLOCK_HZ / 1000000U);
+    uint32_t bin = 0;
+    uint32_t limit = 16U;
+    while(bin < INPUT_LATENCY_BINS - 1U && us >= limit){
+        limit *= 4U;
+        bin++;
+    }
+    input_stats.latency[bin]++;
+}
+
+static bool input_ring_ready(const input_ring_t *ring){
+    return ring->tail != ring->head;
+}
+
+/* Takes from the ring whose oldest event came first, so the two producers
+ * interleave in the order the edges happened */
+bool input_pop(input_event_t *event){
+    bool irq = input_ring_ready(&irq_ring);
+    bool scan = input_ring_ready(&scan_ring);
+    if(!irq && !scan) return 0;
+    atomic_signal_fence(memory_order_acquire); // Slots read after head was seen
+    input_ring_t *ring = irq ? &irq_ring : &scan_ring;
+    if(irq && scan){
+        uint32_t irq_tick = irq_ring.events[irq_ring.tail & (INPUT_RING_SIZE - 1U)].tick;
+        uint32_t scan_tick = scan_ring.events[scan_ring.tail & (INPUT_RING_SIZE - 1U)].tick;
+        if((int32_t)(scan_tick - irq_tick) < 0) ring = &scan_ring;
+    }
+    uint32_t t = ring->tail;
+    *event = ring->events[t & (INPUT_RING_SIZE - 1U)];
+    atomic_signal_fence(memory_order_release); // Slot read before it is given back
+    ring->tail = t + 1U;
+    input_stats.handled++;
+    input_record_latency(hal_ticks() - event->tick);
+    return 1;
+}
+
+bool input_ready(){
+    return input_ring_ready(&irq_ring) || input_ring_ready(&scan_ring);
+}
+
+static void input_remove(uint32_t index){
+    pending_count--;
+    for(uint32_t i = index; i < pending_count; i++) pending[i] = pending[i + 1U];
+}
+
+/* Moves the presses waiting in the rings to the end of the pending list */
+static void input_drain(){
+    input_event_t event;
+    while(input_pop(&event)){
+        if(event.edge != INPUT_EDGE_PRESS || event.button >= INPUT_BUTTONS) continue;
+        if(pending_count == INPUT_PENDING_SIZE){
+            input_remove(0); // Nobody took it in time
+            input_stats.discarded++;
+        }
+        pending[pending_count++] = event;
+    }
+}
+
+bool input_take_first(uint32_t buttons, input_event_t *event){
+    input_drain();
+    for(uint32_t i = 0; i < pending_count; i++){
+        if(!(buttons & INPUT_MASK(pending[i].button))) continue;
+        if(event) *event = pending[i];
+        input_remove(i);
+        return 1;
+    }
+    return 0;
+}
+
+bool input_take(input_button_t button){
+    return input_take_first(INPUT_MASK(button), NULL);
+}
+
+void input_discard(input_button_t button){
+    input_drain();
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < pending_count; i++){
+        if(pending[i].button == button) input_stats.discarded++;
+        else pending[kept++] = pending[i];
+    }
+    pending_count = kept;
+}
@@ -0,0 +1,117 @@
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include <stdatomic.h>
+#include "hal.h"
+
+/*
+ * INPUT EVENTS
+ * The button interrupt handlers and the sampling tick post timestamped
+ * events into one lock-free single-producer ring each, so they may preempt
+ * each other without masking; the main loop drains both in event order.
+ * Draining appends each press to a pending list that keeps the event
+ * order and ticks, so a second press before the loop looks is kept and
+ * presses of different buttons can be handled in the order they were made.
+ * The time from the first edge to the drain is recorded in a latency
+ * histogram.
+ *
+ * DEBOUNCING
+ * The NAV and DIP pins are sampled every millisecond from a software timer,
+ * one port read per port. Each pin shifts its samples into a history word
+ * and changes state once the last 'window' samples agree; the event then
+ * carries the time of the first edge, so the latency includes the
+ * debounce delay. The interrupt buttons ignore a press that follows the
+ * previous one within the window.
+ */
+
+#define INPUT_RING_SIZE    16U // Power of two, per producer
+#define INPUT_PENDING_SIZE 16U // Presses kept for input_take(), the oldest is dropped beyond
+#define INPUT_LATENCY_BINS 8U  // <16us, <64us, <256us, <1ms, <4ms, <16ms, <64ms, more
+#define INPUT_SAMPLE_MS    1U
+#define INPUT_DEBOUNCE_MS  10U // Default window, 1..32 samples
+
+typedef enum {
+    INPUT_SW1 = 0,
+    INPUT_SW2,
+    INPUT_SW3,
+    INPUT_SW4,
+    INPUT_BACK,
+    INPUT_NAV_LEFT,        // Sampled and debounced from here on
+    INPUT_NAV_RIGHT,
+    INPUT_NAV_UP,
+    INPUT_NAV_DOWN,
+    INPUT_DIP1,            // Press = switch on, release = switch off
+    INPUT_DIP2,
+    INPUT_DIP3,
+    INPUT_DIP4,
+    INPUT_DIP5,
+    INPUT_DIP6,
+    INPUT_DIP7,
+    INPUT_DIP8,
+    INPUT_BUTTONS
+} input_button_t;
+
+#define INPUT_FIRST_SAMPLED INPUT_NAV_LEFT
+#define INPUT_SAMPLED       (INPUT_BUTTONS - INPUT_FIRST_SAMPLED)
+
+#define INPUT_MASK(button)  (1UL << (button))  // Button sets for input_take_first()
+
+typedef enum {
+    INPUT_EDGE_PRESS = 0,  // The button IRQs are configured for the falling edge (press only)
+    INPUT_EDGE_RELEASE
+} input_edge_t;
+
+typedef struct {
+    uint8_t button;
+    uint8_t edge;
+    uint32_t tick;  // hal_ticks() at the first edge
+} input_event_t;
+
+/* The posting counters are shared by both producers, hence atomic */
+typedef struct {
+    _Atomic uint32_t posted;
+    _Atomic uint32_t overflows;   // Events lost because a ring was full
+    uint32_t handled;
+    uint32_t discarded;           // Presses dropped by input_discard()
+    _Atomic uint32_t bounces;     // Interrupt presses inside the debounce window, and rejected pin glitches
+    uint32_t latency[INPUT_LATENCY_BINS];
+} input_stats_t;
+
+extern input_stats_t input_stats;
+
+/* Producer side, called from the button interrupt handlers */
+void input_post(input_button_t button, input_edge_t edge);
+
+/* Starts sampling the NAV and DIP pins; their current states are taken as settled */
+void input_scan_start();
+
+void input_scan_stop();
+
+/* Samples that must agree before a pin changes state (1..32, at INPUT_SAMPLE_MS each) */
+void input_set_debounce(uint32_t samples);
+
+/* Debounced state of a sampled input, 1 = pressed / switched on */
+bool input_level(input_button_t button);
+
+/* Debounced DIP switches, DIP1 in bit 0, read in one access */
+uint8_t input_dip();
+
+/* Consumer side, main loop only */
+
+/* Pops the oldest event and records its latency, returns 0 if the rings are empty */
+bool input_pop(input_event_t *event);
+
+/* Events waiting in the rings, e.g. to decide whether to sleep */
+bool input_ready();
+
+/* Drains the rings and consumes the oldest press of 'button', returns 0 if there is none */
+bool input_take(input_button_t button);
+
+/* Consumes the oldest press of any button in 'buttons' (INPUT_MASK bits) and
+ * copies it to 'event' (may be NULL), returns 0 if there is none */
+bool input_take_first(uint32_t buttons, input_event_t *event);
+
+/* Drops the presses of 'button' that nobody is going to handle */
+void input_discard(input_button_t button);
+
+#endif /* INPUT_H_ */
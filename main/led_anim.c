@@ -0,0 +1,66 @@
+#include "hal.h"
+#include "swtimer.h"
+#include "led_ring.h"
+#include "led_anim.h"
+
+static swtimer_t anim_timer;
+static const led_anim_t *anim;
+static uint32_t shown;                     // Keyframe on the ring
+static volatile uint32_t stretch = 1000U;  // Permille of the table durations
+static volatile bool reverse = 0;
+static volatile bool running = 0;
+
+static void anim_step(swtimer_t *timer);
+
+/* Shows keyframe 'shown' and arms the timer for the next one */
+static void anim_show(){
+    const led_keyframe_t *key = &anim->keyframes[shown];
+    uint32_t ms = key->ms * stretch / 1000U;
+    uint8_t levels[LED_RING_COUNT];
+    for(uint32_t i = 0; i < LED_RING_COUNT; i++) levels[i] = ((key->pattern >> i) & 1U) ? key->level : 0U;
+
+    if(key->fade) led_ring_fade(levels, ms);
+    else led_ring_levels(levels);
+    swtimer_start(&anim_timer, ms, 0, anim_step);
+}
+
+/* Timer interrupt: end of the keyframe shown */
+static void anim_step(swtimer_t *timer){
+    uint32_t last = anim->count - 1U;
+    bool end = reverse ? (shown == 0) : (shown == last);
+
+    if(end && !anim->loop){
+        running = 0;
+        return;
+    }
+    if(reverse) shown = (shown == 0) ? last : shown - 1U;
+    else shown = (shown == last) ? 0 : shown + 1U;
+    anim_show();
+}
+
+void led_anim_play(const led_anim_t *next){
+    swtimer_cancel(&anim_timer);
+    anim = next;
+    shown = 0;
+    stretch = 1000U;
+    reverse = 0;
+    running = 1;
+    anim_show();
+}
+
+void led_anim_stop(){
+    swtimer_cancel(&anim_timer);
+    running = 0;
+}
+
+void led_anim_stretch(uint32_t permille){
+    stretch = permille;
+}
+
+void led_anim_reverse(bool backwards){
+    reverse = backwards;
+}
+
+bool led_anim_running(){
+    return running;
+}
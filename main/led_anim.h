@@ -0,0 +1,44 @@
+#ifndef LED_ANIM_H_
+#define LED_ANIM_H_
+
+#include "hal.h"
+
+/*
+ * LED RING ANIMATIONS
+ * An animation is a table of keyframes played on the dimmed ring (see
+ * led_ring.h). A one-shot software timer steps through the table from the
+ * timer interrupt and each keyframe becomes one DMA frame, or a fade of
+ * frames, so the caller keeps running while the ring animates. Speed and
+ * direction are parameters of the player, not of the table.
+ */
+
+typedef struct {
+    uint8_t pattern;  // LEDs lit in this keyframe, the others are off
+    uint8_t level;    // Brightness of the lit LEDs (0..LED_RING_LEVEL_MAX)
+    uint16_t ms;      // Time from the start of this keyframe to the next one
+    bool fade;        // Fade from the previous keyframe over 'ms' instead of switching at once
+} led_keyframe_t;
+
+typedef struct {
+    const led_keyframe_t *keyframes;
+    uint8_t count;
+    bool loop;        // Start over after the last keyframe, else hold it
+} led_anim_t;
+
+/* Plays 'anim' from its first keyframe, forwards and at the table speed.
+ * The ring must be dimmed (led_ring_dim_start()) for as long as it plays. */
+void led_anim_play(const led_anim_t *anim);
+
+/* Stops on the keyframe being shown */
+void led_anim_stop();
+
+/* Scales every keyframe duration by permille / 1000, from the next keyframe on */
+void led_anim_stretch(uint32_t permille);
+
+/* Walks the table backwards, from the next keyframe on */
+void led_anim_reverse(bool reverse);
+
+/* False once a non-looping animation reached its last keyframe, or after led_anim_stop() */
+bool led_anim_running();
+
+#endif /* LED_ANIM_H_ */
@@ -0,0 +1,203 @@
+#include "hal.h"
+#include "led_ring.h"
+#include "led_gamma_lut.h"
+
+#if LED_GAMMA_SLOTS != LED_RING_SLOTS
+#error "led_gamma_lut.h was generated for another PWM resolution"
+#endif
+
+/* Output bits on 'port' of the LEDs that are on in pattern 'x' */
+#define LED_RING_BIT(x, i, port) \
+        (((((x) >> (i)) & 1U) && LED_RING_PORT_##i == (port)) ? (1UL << LED_RING_PIN_##i) : 0UL)
+#define LED_RING_MASK(x, port) \
+        (LED_RING_BIT(x, 0, port) | LED_RING_BIT(x, 1, port) | LED_RING_BIT(x, 2, port) | \
+         LED_RING_BIT(x, 3, port) | LED_RING_BIT(x, 4, port) | LED_RING_BIT(x, 5, port) | \
+         LED_RING_BIT(x, 6, port) | LED_RING_BIT(x, 7, port))
+
+/* All 256 patterns, expanded by the preprocessor */
+#define LED_RING_ROW4(x, port)  LED_RING_MASK((x), port), LED_RING_MASK((x) + 1, port), \
+                                LED_RING_MASK((x) + 2, port), LED_RING_MASK((x) + 3, port)
+#define LED_RING_ROW16(x, port) LED_RING_ROW4((x), port), LED_RING_ROW4((x) + 4, port), \
+                                LED_RING_ROW4((x) + 8, port), LED_RING_ROW4((x) + 12, port)
+#define LED_RING_ROW64(x, port) LED_RING_ROW16((x), port), LED_RING_ROW16((x) + 16, port), \
+                                LED_RING_ROW16((x) + 32, port), LED_RING_ROW16((x) + 48, port)
+#define LED_RING_TABLE(port)    {LED_RING_ROW64(0, port), LED_RING_ROW64(64, port), \
+                                 LED_RING_ROW64(128, port), LED_RING_ROW64(192, port)}
+
+static const uint8_t ring_ports[LED_RING_PORTS] = {HAL_PORT4, HAL_PORT0, HAL_PORT2};
+
+static const uint32_t ring_masks[LED_RING_PORTS][256] = {
+        LED_RING_TABLE(HAL_PORT4),
+        LED_RING_TABLE(HAL_PORT0),
+        LED_RING_TABLE(HAL_PORT2),
+};
+
+/* Position of each LED in the frame words: index into ring_ports and output bit */
+#define LED_RING_INDEX(port) ((port) == HAL_PORT4 ? 0U : (port) == HAL_PORT0 ? 1U : 2U)
+#define LED_RING_LED(i)      {LED_RING_INDEX(LED_RING_PORT_##i), 1UL << LED_RING_PIN_##i}
+
+static const struct {
+    uint8_t port;
+    uint32_t bit;
+} ring_leds[LED_RING_COUNT] = {
+        LED_RING_LED(0), LED_RING_LED(1), LED_RING_LED(2), LED_RING_LED(3),
+        LED_RING_LED(4), LED_RING_LED(5), LED_RING_LED(6), LED_RING_LED(7),
+};
+
+static uint8_t current = 0; // Pattern in the output latches, the ring pins have no other writer
+
+/* Dimming state, shared with the stream interrupt */
+static bool dimmed = 0;
+static uint32_t frames[2][LED_RING_PORTS][LED_RING_SLOTS][2];  // Set (PSOR) and clear (PCOR) word per slot
+static uint8_t frame_duty[2][LED_RING_COUNT];  // Off slot of each LED in each frame, 0 = dark
+static uint32_t playing;                       // Frame the stream is playing
+static bool queued;                            // The other frame waits for the next pass
+static bool dirty;                             // Levels changed since the last frame was rendered
+static uint32_t level_q16[LED_RING_COUNT];     // Current levels, 16.16 fixed point
+static int32_t step_q16[LED_RING_COUNT];       // Change per pass while fading
+static uint8_t target[LED_RING_COUNT];         // Levels at the end of the fade
+static uint32_t fade_passes;                   // Passes left in the fade
+
+void led_ring_write(uint8_t pattern){
+    if(dimmed){
+        uint8_t levels[LED_RING_COUNT];
+        for(uint32_t i = 0; i < LED_RING_COUNT; i++) levels[i] = ((pattern >> i) & 1U) ? LED_RING_LEVEL_MAX : 0U;
+        led_ring_levels(levels);
+        return;
+    }
+    for(uint32_t p = 0; p < LED_RING_PORTS; p++){
+        /* Only the ring pins that differ between the two patterns are flipped */
+        uint32_t change = ring_masks[p][current] ^ ring_masks[p][pattern];
+        if(change) hal_gpio_port_toggle(ring_ports[p], change);
+    }
+    current = pattern;
+}
+
+void led_ring_clear(){
+    if(dimmed){
+        led_ring_write(0);
+        return;
+    }
+    /* Driven low whatever the latches hold, rather than toggled from 'current' */
+    for(uint32_t p = 0; p < LED_RING_PORTS; p++) hal_gpio_port_clear(ring_ports[p], ring_masks[p][0xFF]);
+    current = 0;
+}
+
+void led_ring_init(){
+    dimmed = 0;
+    led_ring_clear();
+}
+
+void led_ring_set(uint8_t led, bool on){
+    uint8_t pattern = led_ring_pattern();
+    pattern = on ? (pattern | (1U << led)) : (pattern & ~(1U << led));
+    led_ring_write(pattern);
+}
+
+uint8_t led_ring_pattern(){
+    if(!dimmed) return current;
+    uint8_t pattern = 0;
+    for(uint32_t i = 0; i < LED_RING_COUNT; i++){
+        if(level_q16[i] >> 16) pattern |= (uint8_t)(1U << i);
+    }
+    return pattern;
+}
+
+#define RING_SET   0U
+#define RING_CLEAR 1U
+
+/* Moves the on and off writes of every LED in frame 'buf' to the current
+ * levels: on in slot 0 and off in its duty slot, or off in slot 0 when dark */
+static void ring_render(uint32_t buf){
+    for(uint32_t i = 0; i < LED_RING_COUNT; i++){
+        uint32_t (*slot)[2] = frames[buf][ring_leds[i].port];
+        uint32_t bit = ring_leds[i].bit;
+        uint8_t old = frame_duty[buf][i];
+        uint8_t duty = led_gamma_lut[level_q16[i] >> 16];
+        if(old){
+            slot[0][RING_SET] &= ~bit;
+            slot[old][RING_CLEAR] &= ~bit;
+        } else {
+            slot[0][RING_CLEAR] &= ~bit;
+        }
+        if(duty){
+            slot[0][RING_SET] |= bit;
+            slot[duty][RING_CLEAR] |= bit;
+        } else {
+            slot[0][RING_CLEAR] |= bit;
+        }
+        frame_duty[buf][i] = duty;
+    }
+}
+
+static void ring_frame_started();
+
+/* Steps the fade and queues a frame when the levels changed, unless one is
+ * already queued: its start calls back here. Runs with interrupts masked or
+ * from the stream interrupt. */
+static void ring_advance(){
+    if(queued) return;
+    if(fade_passes){
+        fade_passes--;
+        for(uint32_t i = 0; i < LED_RING_COUNT; i++){
+            level_q16[i] = fade_passes ? level_q16[i] + (uint32_t)step_q16[i] : (uint32_t)target[i] << 16;
+        }
+        dirty = 1;
+    }
+    if(dirty){
+        uint32_t next = playing ^ 1U;
+        ring_render(next);
+        hal_gpio_stream_next(&frames[next][0][0][0], ring_frame_started);
+        queued = 1;
+        dirty = 0;
+    }
+}
+
+/* Stream interrupt: the queued frame replaced the playing one */
+static void ring_frame_started(){
+    playing ^= 1U;
+    queued = 0;
+    ring_advance();
+}
+
+void led_ring_dim_start(){
+    led_ring_write(0);
+    for(uint32_t i = 0; i < LED_RING_COUNT; i++) level_q16[i] = 0;
+    ring_render(0);
+    ring_render(1);
+    playing = 0;
+    queued = 0;
+    dirty = 0;
+    fade_passes = 0;
+    dimmed = 1;
+    hal_gpio_stream_start(ring_ports, LED_RING_PORTS, &frames[0][0][0][0], LED_RING_SLOTS,
+                          HAL_TIMER_CLOCK_HZ / (LED_RING_SLOTS * LED_RING_FRAME_HZ));
+}
+
+void led_ring_dim_stop(){
+    hal_gpio_stream_stop();
+    dimmed = 0;
+    led_ring_clear(); // Stopped anywhere in a pass
+}
+
+void led_ring_levels(const uint8_t levels[LED_RING_COUNT]){
+    hal_irq_disable();
+    fade_passes = 0;
+    for(uint32_t i = 0; i < LED_RING_COUNT; i++) level_q16[i] = (uint32_t)levels[i] << 16;
+    dirty = 1;
+    ring_advance();
+    hal_irq_enable();
+}
+
+void led_ring_fade(const uint8_t levels[LED_RING_COUNT], uint32_t ms){
+    uint32_t passes = ms * LED_RING_FRAME_HZ / 1000U;
+    if(passes == 0) passes = 1;
+    hal_irq_disable();
+    for(uint32_t i = 0; i < LED_RING_COUNT; i++){
+        target[i] = levels[i];
+        step_q16[i] = (int32_t)(((uint32_t)levels[i] << 16) - level_q16[i]) / (int32_t)passes;
+    }
+    fade_passes = passes;
+    ring_advance();
+    hal_irq_enable();
+}
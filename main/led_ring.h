@@ -0,0 +1,82 @@
+#ifndef LED_RING_H_
+#define LED_RING_H_
+
+#include "hal.h"
+
+/*
+ * LED RING DRIVER
+ * The 8 ring LEDs sit on three ports (LED1 on GPIO4, LED2-4 on GPIO0,
+ * LED5-8 on GPIO2). For every 8-bit pattern the output mask of each port
+ * is precomputed at compile time from the pin map below, so an update is
+ * two table lookups per port and one toggle (PTOR) write per port whose
+ * LEDs actually change: at most three writes, and each port switches all
+ * its LEDs at once, so no intermediate pattern is ever shown. Switching
+ * the ring off (led_ring_init, led_ring_clear) drives every ring pin low
+ * with clear (PCOR) writes instead, so it holds whatever the pins showed.
+ * Bit i of a pattern is LED i + 1, 1 = on.
+ *
+ * DIMMING
+ * Between led_ring_dim_start() and led_ring_dim_stop() each LED has an
+ * 8-bit brightness. A frame holds LED_RING_SLOTS slots of PSOR/PCOR word
+ * pairs (one per port) that the GPIO stream plays by DMA at
+ * LED_RING_FRAME_HZ: an LED is set in slot 0 and cleared in the slot given
+ * by the gamma table, so the CPU never toggles a pin to dim it and a
+ * misplayed slot is corrected by the next pass. Two frame buffers alternate; only the
+ * pass that swaps them interrupts the CPU, and fades step once per pass.
+ * led_ring_write() and led_ring_set() show full/off levels while dimmed.
+ */
+
+#define LED_RING_COUNT 8U
+#define LED_RING_PORTS 3U
+
+#define LED_RING_SLOTS    256U  // PWM resolution, duty steps per frame
+#define LED_RING_FRAME_HZ 200U
+#define LED_RING_LEVEL_MAX 255U
+
+/* Pin map, in ring order */
+#define LED_RING_PORT_0 HAL_PORT4
+#define LED_RING_PIN_0  SHIELD_LED1_GPIO_PIN
+#define LED_RING_PORT_1 HAL_PORT0
+#define LED_RING_PIN_1  SHIELD_LED2_GPIO_PIN
+#define LED_RING_PORT_2 HAL_PORT0
+#define LED_RING_PIN_2  SHIELD_LED3_GPIO_PIN
+#define LED_RING_PORT_3 HAL_PORT0
+#define LED_RING_PIN_3  SHIELD_LED4_GPIO_PIN
+#define LED_RING_PORT_4 HAL_PORT2
+#define LED_RING_PIN_4  SHIELD_LED5_GPIO_PIN
+#define LED_RING_PORT_5 HAL_PORT2
+#define LED_RING_PIN_5  SHIELD_LED6_GPIO_PIN
+#define LED_RING_PORT_6 HAL_PORT2
+#define LED_RING_PIN_6  SHIELD_LED7_GPIO_PIN
+#define LED_RING_PORT_7 HAL_PORT2
+#define LED_RING_PIN_7  SHIELD_LED8_GPIO_PIN
+
+/* Takes the ring over once its pins are configured, all LEDs off */
+void led_ring_init();
+
+/* Shows 'pattern' on the ring. Only the pins that differ from the pattern
+ * last written are toggled, so the latches must hold it (led_ring_init). */
+void led_ring_write(uint8_t pattern);
+
+/* Switches all LEDs off with clear (PCOR) writes, whatever the pins show */
+void led_ring_clear();
+
+/* Switches a single LED, leaving the others as they are */
+void led_ring_set(uint8_t led, bool on);
+
+/* Pattern currently shown, while dimmed the LEDs with a level above 0 */
+uint8_t led_ring_pattern();
+
+/* Hands the ring pins to the DMA frame engine, all LEDs off */
+void led_ring_dim_start();
+
+/* Stops the frame engine and switches all LEDs off */
+void led_ring_dim_stop();
+
+/* Brightness of each LED (0..LED_RING_LEVEL_MAX, perceived), from the next frame on */
+void led_ring_levels(const uint8_t levels[LED_RING_COUNT]);
+
+/* Moves every LED linearly from its current level to 'levels' over 'ms' */
+void led_ring_fade(const uint8_t levels[LED_RING_COUNT], uint32_t ms);
+
+#endif /* LED_RING_H_ */
@@ -1,120 +1,82 @@
-#include "board.h"
-#include "app.h"
-#include <stdio.h>
-#include "peripherals.h"
-#include "pin_mux.h"
-#include "clock_config.h"
-#include "MCXN947_cm33_core0.h"
-#include "fsl_debug_console.h"
-#include "fsl_lpi2c.h"
-#include "fsl_device_registers.h"
+#include "hal.h"
 #include "oled.h"
-#include "math.h"
+#include "oled_fb.h"
+#include "oled_queue.h"
+#include "input.h"
+#include "adc_scan.h"
 #include "leds.h"
+#include "trend.h"
+#include "numfield.h"
 #include "light_intensity.h"
 
-uint8_t adc_f; // Flag to trigger a new ADC reading after a full LED cycle
+uint8_t adc_f; // Set when the scan latched a new 30 s sample
 
 void light(){
-    /* 1. TIMER CONFIGURATION
-     * Set up CTIMER0 to generate a match interrupt. 
-     * This controls the timing for the 8-LED progress ring.
+    /* 1. LED RING CONFIGURATION
+     * Countdown animation on the 8-LED progress ring, played by timer and DMA.
      */
-    matchConfig = CTIMER0_Match_0_config;
-    matchConfig.matchValue = 562500000U; // Adjust value for desired blinking speed
-    CTIMER_SetupMatch(CTIMER0_PERIPHERAL, CTIMER0_MATCH_0_CHANNEL, &matchConfig);
-    CTIMER_StartTimer(CTIMER0_PERIPHERAL);
+    hal_set_module(HAL_MOD_LIGHT);
+    led_ring_dim_start();
 
     /* 2. INITIAL ADC READING
-     * Configure ADC0 command for the Photodiode sensor input.
+     * Latest photodiode sample from the background scan.
      */
-    ADC0->CMD->CMDL = 0x20; // Set command for light sensor input channel
-    LPADC_DoSoftwareTrigger(ADC0, 1); // Trigger the first conversion
-    LPADC_GetConvResultBlocking(ADC0, &result, 0); // Wait for data
-
-    /* Convert 16-bit raw value to a manageable 13-bit range for display */
-    uint16_t light_value = result.convValue >> 3;
+    uint16_t light_value = adc_scan_value(ADC_SCAN_PHOTODIODE) >> 3; // 16-bit raw to 13-bit for display
             
-    resetOLED();
-    sendOLED((uint8_t*)frame6, 94, OLED_DATA); // Display "Light:" or icon frame
-    setSeg(95); // Move cursor to the value position on OLED
+    fb_reset();
+    fb_draw(0, 0, (const uint8_t*)frame6, 94); // Display "Light:" or icon frame, value starts at column 95
 
-    uint8_t current_led = 0; // Index for the 8-LED ring (0 to 7)
+    led_anim_play(&leds_countdown);
+    uint32_t interval = adc_scan_intervals();
 
     /* 3. DECIMAL TO OLED CONVERSION
-     * Algorithm to extract each digit of the light_value for character rendering.
+     * Up to 4 digits (13-bit value), right-aligned from column 95.
      */
-    uint16_t div = 1;
-    while(light_value / div >= 10) {
-        div *= 10;
-    }
-
-    while(div > 0) {
-        uint8_t digit = (light_value / div) % 10;
-        const char *tmp = &font[digit][0]; // Fetch character from font table
-        sendOLED((uint8_t*)tmp, 6, OLED_DATA);
-        div /= 10;
-    }   
+    numfield_t field;
+    numfield_init(&field, 0, 95, 4, 0);
+    numfield_set(&field, light_value);
+    fb_flush();
 
-    /* Initial LED state update */
-    if(timer_flag){
-        GPIO_PinWrite(LEDs[current_led].gpio, LEDs[current_led].pin, 1);
-        current_led = (current_led == 8) ? 0 : current_led + 1; 
-        timer_flag = 0;
-    }
+    /* Last minute of 1 s points under the value, scrolled in as they arrive */
+    trend_t trend;
+    trend_start(&trend, ADC_SCAN_PHOTODIODE, NULL);
 
     /* 4. MONITORING LOOP
-     * Continues until the 'exit_flag' is set by the Back button interrupt.
+     * Continues until the Back button is pressed.
+     * A refresh the queue cannot take stays dirty and goes out with the
+     * next one, so a busy bus never holds up the Back button.
      */
-    while(!exit_flag){
-                
-        /* Update OLED value only when a full LED cycle is complete (adc_f == 1) */
+    oledq_set_policy(OLEDQ_POLICY_DROP);
+    while(!input_take(INPUT_BACK)){
+
+        /* A new 30 s sample was latched on the CTIMER1 trigger grid */
+        if(adc_scan_intervals() != interval){
+            interval = adc_scan_intervals();
+            adc_f = 1;
+        }
+
+        /* Update OLED value only when a new interval sample arrived (adc_f == 1) */
         if(adc_f){
-            LPADC_DoSoftwareTrigger(ADC0, 1);
-            LPADC_GetConvResultBlocking(ADC0, &result, 0);
-            
-            resets_led(); // Clear the LED ring for the next cycle
-            setSeg(95); 
+            uint16_t raw = adc_scan_interval(ADC_SCAN_PHOTODIODE).value;
             
-            /* Clear previous numerical value on OLED using blank pixels */
-            uint8_t delet[18] = {0x00}; 
-            sendOLED((uint8_t*)delet, 18, OLED_DATA);
+            /* Restart the countdown so the ring fills in step with the sample period */
+            led_anim_play(&leds_countdown);
             
-            setSeg(95);
-            light_value = result.convValue >> 3;
+            light_value = raw >> 3;
             
-            /* Re-display updated value */
-            div = 1;
-            while(light_value / div >= 10) div *= 10;
-            while(div > 0) {
-                uint8_t digit = (light_value / div) % 10;
-                const char *tmp = &font[digit][0];
-                sendOLED((uint8_t*)tmp, 6, OLED_DATA);
-                div /= 10;
-            }   
+            /* Re-display updated value, only changed digits are redrawn */
+            numfield_set(&field, light_value);
+            fb_flush();
             adc_f = 0; // Reset ADC trigger flag
         }
-
-        /* LED RING LOGIC
-         * Each timer interrupt lights up the next LED in the circle.
-         * When the 8th LED (index 7) is reached, trigger a new sensor reading.
-         */
-        if(timer_flag){
-            GPIO_PinWrite(LEDs[current_led].gpio, LEDs[current_led].pin, 1);
-            
-            // Check if we finished the circle (8 LEDs)
-            adc_f = (current_led == 7) ? 1 : 0;
-            current_led = (current_led == 7) ? 0 : current_led + 1; 
-            
-            timer_flag = 0; // Clear the timer interrupt flag
-        }
+        trend_update(&trend);
+        hal_idle();
     }
 
     /* 5. CLEANUP & EXIT
      * Stop hardware resources before returning to the main menu.
      */
-    exit_flag = 0;
-    CTIMER_Reset(CTIMER0);
-    CTIMER_StopTimer(CTIMER0);
-    resets_led(); // Turn off all LEDs
+    oledq_set_policy(OLEDQ_POLICY_BLOCK);
+    led_anim_stop();
+    led_ring_dim_stop(); // Turn off all LEDs
 }
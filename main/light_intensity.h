@@ -1,18 +1,8 @@
 #ifndef LIGHT_INTENSITY_H_
 #define LIGHT_INTENSITY_H_
 
-#include "board.h"
-#include "app.h"
-#include <stdio.h>
-#include "peripherals.h"
-#include "pin_mux.h"
-#include "clock_config.h"
-#include "MCXN947_cm33_core0.h"
-#include "fsl_debug_console.h"
-#include "fsl_lpi2c.h"
-#include "fsl_device_registers.h"
+#include "hal.h"
 #include "oled.h"
-#include "math.h"
 #include "leds.h"
 
 void light();
@@ -11,29 +11,43 @@
 #include "fsl_device_registers.h"
 #include "oled.h"
 #include "math.h"
+#include "hal.h"
+#include "oled_fb.h"
+#include "menu.h"
+#include "adc_scan.h"
+#include "input.h"
+#include "sched.h"
+#include "swtimer.h"
 #include "leds.h"
+#include "encoder.h"
 #include "temperature.h"
 #include "light_intensity.h"
 #include "game.h"
+#include "entropy.h"
+#include "telemetry.h"
+#include "trace.h"
 
 /* * INTERRUPT HANDLERS
- * Each handler sets a specific flag when a button is pressed.
- * These flags are then processed in the main loop (polling).
+ * Each handler posts a timestamped press into the input event ring.
+ * The events release the menu tasks run by the scheduler. All button
+ * IRQs keep the same NVIC priority so that they form a single producer.
  */
 
 /* GPIO40_IRQn: Handles SW1 interrupt - Typically used for Option 1 / Selection */
 void GPIO4_INT_0_IRQHANDLER(void)
 {
     uint32_t pin_flags0 = GPIO_GpioGetInterruptChannelFlags(GPIO4, 0U);
-    sw1_flag = 1; // Set flag for Software Button 1
+    input_post(INPUT_SW1, INPUT_EDGE_PRESS);
     GPIO_GpioClearInterruptChannelFlags(GPIO4, pin_flags0, 0U);
     SDK_ISR_EXIT_BARRIER;
 }
 
-/* GPIO30_IRQn: Handles SW2 interrupt - Typically used for Option 2 / Selection */
+/* GPIO30_IRQn: Handles SW2 interrupt - Typically used for Option 2 / Selection.
+ * The rotary encoder channels share this interrupt while encoder_leds() runs. */
 void GPIO3_INT_0_IRQHANDLER(void) {
     uint32_t pin_flags0 = GPIO_GpioGetInterruptChannelFlags(GPIO3, 0U);
-    sw2_flag = 1; // Set flag for Software Button 2
+    if(pin_flags0 & ENCODER_PIN_MASK) encoder_edge();
+    if(pin_flags0 & ~ENCODER_PIN_MASK) input_post(INPUT_SW2, INPUT_EDGE_PRESS);
     GPIO_GpioClearInterruptChannelFlags(GPIO3, pin_flags0, 0U); 
     SDK_ISR_EXIT_BARRIER;
 }
@@ -41,7 +55,7 @@ void GPIO3_INT_0_IRQHANDLER(void) {
 /* GPIO00_IRQn: Handles Exit/Back interrupt - Used to return to previous menu */
 void GPIO0_INT_0_IRQHANDLER(void) {
     uint32_t pin_flags0 = GPIO_GpioGetInterruptChannelFlags(GPIO0, 0U);
-    exit_flag = 1; // Set global exit flag
+    input_post(INPUT_BACK, INPUT_EDGE_PRESS);
     GPIO_GpioClearInterruptChannelFlags(GPIO0, pin_flags0, 0U); 
     SDK_ISR_EXIT_BARRIER;
 }
@@ -49,7 +63,7 @@ void GPIO0_INT_0_IRQHANDLER(void) {
 /* GPIO31_IRQn: Handles SW4 interrupt - Typically used for LED Games Menu */
 void GPIO3_INT_1_IRQHANDLER(void) {
     uint32_t pin_flags1 = GPIO_GpioGetInterruptChannelFlags(GPIO3, 1U);
-    sw4_flag = 1; // Set flag for Software Button 4
+    input_post(INPUT_SW4, INPUT_EDGE_PRESS);
     GPIO_GpioClearInterruptChannelFlags(GPIO3, pin_flags1, 1U); 
     SDK_ISR_EXIT_BARRIER;
 }
@@ -57,126 +71,137 @@ void GPIO3_INT_1_IRQHANDLER(void) {
 /* GPIO01_IRQn: Handles SW3 interrupt - Typically used for Games Menu */
 void GPIO0_INT_1_IRQHANDLER(void) {
     uint32_t pin_flags1 = GPIO_GpioGetInterruptChannelFlags(GPIO0, 1U);
-    sw3_flag = 1; // Set flag for Software Button 3
+    input_post(INPUT_SW3, INPUT_EDGE_PRESS);
     GPIO_GpioClearInterruptChannelFlags(GPIO0, pin_flags1, 1U); 
     SDK_ISR_EXIT_BARRIER;
 }
 
-/* Timer Callback: Used for periodic tasks like sensor readings */
+/* Timer Callback: 1 ms tick of the software timers */
 void ctimer_match_callback(uint32_t flags)
 {
-    timer_flag = 1; 
+    swtimer_tick();
 }
 
-/* Renders the Main Menu frames on the OLED display */
-void OLED_main_meniu(){
-    sendOLED((uint8_t*)frame1, 42, OLED_DATA);
-    setPage(1);
-    setSeg(0);
-    sendOLED((uint8_t*)frame2, 80, OLED_DATA);
-    setPage(2);
-    setSeg(0);
-    sendOLED((uint8_t*)frame3, 100, OLED_DATA);
-    setPage(3);
-    setSeg(0);
-    sendOLED((uint8_t*)frame4, 38, OLED_DATA);
-    setPage(4);
-    setSeg(0);
-    sendOLED((uint8_t*)frame12, 38, OLED_DATA);
+/* --- MENU TASKS ---
+ * Each menu is a table of tasks released by button presses; a submenu
+ * runs its own table until the Back button is pressed.
+ */
+
+/* Option 1: Temperature Monitoring */
+static void temperature_task(){
+    fb_reset();
+    temperatures(); // Enter temperature module
+    fb_reset();
+    OLED_main_meniu(); // Return to main menu
+}
+
+/* Option 2: Light Intensity Monitoring */
+static void light_task(){
+    light(); // Enter light intensity module
+    fb_reset();
+    OLED_main_meniu();
+}
+
+static void guess_number_task(){
+    guess_number(); // Game: Guess the 8-bit number
+    fb_reset();
+    game_meniu();
+}
+
+static void row_game_task(){
+    row_game(); // Game: Memory sequence
+    fb_reset();
+    game_meniu();
+}
+
+static const sched_task_t game_tasks[] = {
+        {INPUT_SW1, guess_number_task},
+        {INPUT_SW2, row_game_task},
+};
+
+/* Option 3: Games Submenu */
+static void games_task(){
+    fb_reset();
+    game_meniu();
+    sched_run(game_tasks, sizeof(game_tasks) / sizeof(game_tasks[0]), INPUT_BACK);
+    fb_reset();
+    OLED_main_meniu();
+}
+
+static const sched_task_t leds_tasks[] = {
+        {INPUT_SW1, leds_delay_control}, // Potentiometer speed control
+        {INPUT_SW2, encoder_leds},       // Rotary encoder direction control
+};
+
+/* Option 4: LED Effects Submenu */
+static void leds_task(){
+    fb_reset();
+    oled_leds_meniu();
+    sched_run(leds_tasks, sizeof(leds_tasks) / sizeof(leds_tasks[0]), INPUT_BACK);
+    fb_reset();
+    OLED_main_meniu();
 }
 
+static const char *const entropy_sources[] = {"none", "trng", "adc"};
+
+static const sched_task_t menu_tasks[] = {
+        {INPUT_SW1, temperature_task},
+        {INPUT_SW2, light_task},
+        {INPUT_SW3, games_task},
+        {INPUT_SW4, leds_task},
+};
+
 int main(void) {
     /* Initialize System Hardware */
     BOARD_InitBootPins();
     BOARD_InitBootClocks();
     BOARD_InitBootPeripherals();
+    hal_init();
+    trace_init(); // DWT cycle counter for the TRACE_BEGIN/TRACE_END scopes
+    swtimer_init();
 
 #ifndef BOARD_INIT_DEBUG_CONSOLE_PERIPHERAL
     BOARD_InitDebugConsole();
 #endif
+    hal_uart_init(); // Telemetry goes out over the same UART by EDMA
 
     /* Initialize Peripherals: LEDs, Buttons, Switches, and Sensors */
     BOARD_InitLEDsPins();
     BOARD_InitBUTTONsPins();
     SHIELD_InitLEDsPins();
+    led_ring_init();
     SHIELD_InitBUTTONsPins();
     SHIELD_DIPSwitchPins();
     SHIELD_RotaryPins();
     SHIELD_NAVSwitchPins();
 
+    /* NAV and DIP debounce from here on, seeded from the configured pins */
+    input_scan_start();
+
     /* I2C Clock Configuration for OLED communication */
     CLOCK_SetClkDiv(kCLOCK_DivFlexcom2Clk, 1u);
     CLOCK_AttachClk(kFRO12M_to_FLEXCOMM2);
 
     initOLED();
+    hal_i2c_init(); // Background OLED transfers over EDMA
     OLED_main_meniu(); // Draw initial menu
     
-    /* Generate RNG Seed using floating ADC reads */
+    /* Seed the RNG from the TRNG or the floating ADC pin, while the menu is still on the bus */
     seed_generator();
 
-    /* MAIN EVENT LOOP */
-    while(1)
-    {   
-        /* Option 1: Temperature Monitoring */
-        if(sw1_flag){
-            sw1_flag = 0;
-            resetOLED();
-            temperatures(); // Enter temperature module
-            resetOLED();
-            OLED_main_meniu(); // Return to main menu
-        }
-
-        /* Option 2: Light Intensity Monitoring */
-        if(sw2_flag){
-            sw2_flag = 0;
-            light(); // Enter light intensity module
-            resetOLED();
-            OLED_main_meniu();
-        }
-
-        /* Option 3: Games Submenu */
-        if(sw3_flag){
-            sw3_flag = 0;
-            resetOLED();
-            game_meniu();
-            while(!exit_flag){
-                if(sw1_flag){
-                    sw1_flag = 0;
-                    guess_number(); // Game: Guess the 8-bit number
-                    resetOLED();
-                    game_meniu();
-                }
-                if(sw2_flag){
-                    sw2_flag = 0;
-                    row_game(); // Game: Memory sequence
-                    resetOLED();
-                    game_meniu();
-                }
-            }
-            exit_flag = 0;
-            resetOLED();
-            OLED_main_meniu();
-        }   
-
-        /* Option 4: LED Effects Submenu */
-        if(sw4_flag){
-            sw4_flag = 0;
-            resetOLED();
-            oled_leds_meniu();
-            while(!exit_flag){
-                if(sw1_flag){
-                    sw1_flag = 0;
-                    leds_delay_control(); // Potentiometer speed control
-                }
-                if(sw2_flag){
-                    sw2_flag = 0;
-                    encoder_leds(); // Rotary encoder direction control
-                }
-            }
-            exit_flag = 0;
-            resetOLED();
-            OLED_main_meniu();
-        }
-    }
+    /* Sensors are sampled in the background from here on */
+    adc_scan_start();
+
+    /* Boot-to-menu time, from hal_init() where the CTIMER2 timebase starts */
+    uint32_t boot_ticks = hal_ticks();
+    PRINTF("boot: menu after %u us, seed from %s in %u us (%u ADC blocks)\r\n",
+           boot_ticks / (HAL_TIMER_CLOCK_HZ / 1000000U), entropy_sources[entropy_stats.source],
+           entropy_stats.ticks / (HAL_TIMER_CLOCK_HZ / 1000000U), entropy_stats.adc_blocks);
+
+    /* Binary telemetry from here on, the console is no longer used for text */
+    telemetry_start();
+
+    /* MAIN EVENT LOOP: the core sleeps until a button task is released */
+    sched_run(menu_tasks, sizeof(menu_tasks) / sizeof(menu_tasks[0]), SCHED_FOREVER);
     return 0;
 }
@@ -0,0 +1,14 @@
+#include "hal.h"
+#include "oled.h"
+#include "oled_fb.h"
+#include "menu.h"
+
+void OLED_main_meniu(){
+    hal_set_module(HAL_MOD_MENU);
+    fb_draw(0, 0, (const uint8_t*)frame1, 42);
+    fb_draw(1, 0, (const uint8_t*)frame2, 80);
+    fb_draw(2, 0, (const uint8_t*)frame3, 100);
+    fb_draw(3, 0, (const uint8_t*)frame4, 38);
+    fb_draw(4, 0, (const uint8_t*)frame12, 38);
+    fb_flush();
+}
@@ -0,0 +1,9 @@
+#ifndef MENU_H_
+#define MENU_H_
+
+#include "hal.h"
+
+/* Renders the Main Menu frames on the OLED display */
+void OLED_main_meniu();
+
+#endif /* MENU_H_ */
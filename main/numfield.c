@@ -0,0 +1,66 @@
+#include "hal.h"
+#include "oled.h"
+#include "oled_fb.h"
+#include "trace.h"
+#include "numfield.h"
+
+#define NUMFIELD_MINUS   10U
+#define NUMFIELD_BLANK   11U
+#define NUMFIELD_UNKNOWN 0xFFU  // Not drawn yet
+
+/* Glyphs missing from the digit font, same 6-column cell */
+static const uint8_t glyph_minus[NUMFIELD_CELL] = {0x08, 0x08, 0x08, 0x08, 0x00, 0x00};
+static const uint8_t glyph_point[NUMFIELD_POINT] = {0x60, 0x60, 0x00};
+
+/* x / 10 for any 32-bit x: 0xCCCCCCCD is 2^35 / 10 rounded up */
+static uint32_t numfield_div10(uint32_t x){
+    return (uint32_t)(((uint64_t)x * 0xCCCCCCCDULL) >> 35);
+}
+
+/* First column of a cell, the point sits before the last 'decimals' cells */
+static uint8_t numfield_column(const numfield_t *field, uint32_t cell){
+    uint32_t column = field->seg + cell * NUMFIELD_CELL;
+    if(field->decimals && cell >= (uint32_t)(field->cells - field->decimals)) column += NUMFIELD_POINT;
+    return (uint8_t)column;
+}
+
+void numfield_init(numfield_t *field, uint8_t page, uint8_t seg, uint8_t cells, uint8_t decimals){
+    if(cells > NUMFIELD_MAX_CELLS) cells = NUMFIELD_MAX_CELLS;
+    field->page = page;
+    field->seg = seg;
+    field->cells = cells;
+    field->decimals = decimals;
+    for(uint32_t i = 0; i < NUMFIELD_MAX_CELLS; i++) field->shown[i] = NUMFIELD_UNKNOWN;
+}
+
+void numfield_set(numfield_t *field, int32_t value){
+    TRACE_BEGIN(TRACE_DIGITS);
+    uint8_t glyphs[NUMFIELD_MAX_CELLS];
+    uint32_t magnitude = (value < 0) ? 0U - (uint32_t)value : (uint32_t)value;
+    uint32_t digits = 0;
+    int32_t cell = field->cells - 1;
+
+    /* Digits from the right, at least through the one before the point */
+    while(cell >= 0 && (digits == 0 || magnitude != 0 || digits <= field->decimals)){
+        uint32_t quotient = numfield_div10(magnitude);
+        glyphs[cell--] = (uint8_t)(magnitude - quotient * 10U);
+        magnitude = quotient;
+        digits++;
+    }
+    if(value < 0 && cell >= 0) glyphs[cell--] = NUMFIELD_MINUS;
+    while(cell >= 0) glyphs[cell--] = NUMFIELD_BLANK;
+
+    if(field->decimals && field->shown[0] == NUMFIELD_UNKNOWN){
+        fb_draw(field->page, numfield_column(field, field->cells - field->decimals) - NUMFIELD_POINT, glyph_point,
+                NUMFIELD_POINT);
+    }
+    for(uint32_t i = 0; i < field->cells; i++){
+        if(glyphs[i] == field->shown[i]) continue;
+        uint8_t column = numfield_column(field, i);
+        if(glyphs[i] == NUMFIELD_BLANK) fb_clear_area(field->page, column, NUMFIELD_CELL);
+        else if(glyphs[i] == NUMFIELD_MINUS) fb_draw(field->page, column, glyph_minus, NUMFIELD_CELL);
+        else fb_draw(field->page, column, (const uint8_t*)&font[glyphs[i]][0], NUMFIELD_CELL);
+        field->shown[i] = glyphs[i];
+    }
+    TRACE_END(TRACE_DIGITS);
+}
@@ -0,0 +1,41 @@
+#ifndef NUMFIELD_H_
+#define NUMFIELD_H_
+
+#include "hal.h"
+
+/*
+ * NUMERIC FIELD
+ * A decimal value drawn right-aligned into a fixed run of 6-column glyph
+ * cells on one page of the framebuffer, with an optional decimal point
+ * (2 columns and a gap) before the last 'decimals' digits and a minus in
+ * the cell left of the leading digit. The field remembers the glyph of
+ * every cell and only redraws the cells whose glyph changed, so the rest
+ * of the field is never blanked and redrawn: a value that changes one
+ * digit costs one 6-byte glyph write. Digits come from a reciprocal
+ * multiplication instead of a division per digit.
+ * Drawing goes to the framebuffer, the caller flushes.
+ */
+
+#define NUMFIELD_MAX_CELLS 10U  // Every uint32_t fits
+#define NUMFIELD_CELL      6U   // Columns per glyph cell
+#define NUMFIELD_POINT     3U   // Columns of the decimal point cell
+
+typedef struct {
+    uint8_t page;
+    uint8_t seg;                        // First column
+    uint8_t cells;                      // Digits and minus
+    uint8_t decimals;                   // Digits after the point, 0 = no point
+    uint8_t shown[NUMFIELD_MAX_CELLS];  // Glyph drawn in each cell
+} numfield_t;
+
+/* Columns taken by a field */
+#define NUMFIELD_WIDTH(cells, decimals) ((cells) * NUMFIELD_CELL + ((decimals) ? NUMFIELD_POINT : 0U))
+
+/* Places an empty field; the first numfield_set() draws every cell */
+void numfield_init(numfield_t *field, uint8_t page, uint8_t seg, uint8_t cells, uint8_t decimals);
+
+/* Shows 'value' in units of 10^-decimals, e.g. 2347 as 23.47. A value with
+ * more digits than cells keeps its lowest ones. */
+void numfield_set(numfield_t *field, int32_t value);
+
+#endif /* NUMFIELD_H_ */
@@ -0,0 +1,81 @@
+#include "hal.h"
+#include "oled_queue.h"
+#include "oled_cmd.h"
+
+oledc_stats_t oledc_stats;
+
+static oledc_mode_t mode = OLEDC_MODE_UNKNOWN;
+
+void oledc_begin(oledc_txn_t *txn){
+    txn->len = 0;
+    txn->data = 0;
+    txn->mode = mode;
+}
+
+void oledc_command(oledc_txn_t *txn, uint8_t cmd){
+    txn->buf[txn->len++] = OLEDQ_TRANSACTION; // Co = 1, D/C = 0: one command byte follows
+    txn->buf[txn->len++] = cmd;
+}
+
+void oledc_data(oledc_txn_t *txn, const uint8_t *data, uint32_t len){
+    if(!txn->data){
+        txn->buf[txn->len++] = OLEDQ_DATA; // Co = 0: the rest of the transaction is data
+        txn->data = 1;
+    }
+    for(uint32_t i = 0; i < len; i++) txn->buf[txn->len++] = data[i];
+}
+
+static void oledc_set_mode(oledc_txn_t *txn, oledc_mode_t new_mode){
+    if(txn->mode == new_mode) return;
+    oledc_command(txn, 0x20);
+    oledc_command(txn, (new_mode == OLEDC_MODE_HORIZONTAL) ? 0x00 : 0x02);
+    txn->mode = new_mode;
+}
+
+void oledc_cursor(oledc_txn_t *txn, uint8_t page, uint8_t column){
+    oledc_set_mode(txn, OLEDC_MODE_PAGE);
+    oledc_command(txn, 0xB0 | (page & 0x07));
+    oledc_command(txn, column & 0x0F);
+    oledc_command(txn, 0x10 | (column >> 4));
+}
+
+void oledc_window(oledc_txn_t *txn, uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1){
+    oledc_set_mode(txn, OLEDC_MODE_HORIZONTAL);
+    oledc_command(txn, 0x21);
+    oledc_command(txn, col0);
+    oledc_command(txn, col1);
+    oledc_command(txn, 0x22);
+    oledc_command(txn, page0);
+    oledc_command(txn, page1);
+}
+
+uint32_t oledc_send(oledc_txn_t *txn){
+    if(txn->len == 0) return 0;
+    /* buf[0] goes out as the first control byte */
+    if(!oledq_push(txn->buf[0], &txn->buf[1], txn->len - 1U)) return 0;
+    mode = txn->mode; // Only a queued mode switch reaches the controller
+    oledc_stats.transactions++;
+    oledc_stats.bus_bytes += txn->len + 1U;
+    return txn->len + 1U;
+}
+
+uint32_t oledc_switch_cost(oledc_mode_t new_mode){
+    return (mode == new_mode) ? 0 : OLEDC_MODE_SWITCH;
+}
+
+void oledc_page_mode(){
+    if(mode == OLEDC_MODE_PAGE) return;
+    oledq_wait(); // The driver needs the switch, even under the DROP policy
+    oledc_txn_t txn;
+    oledc_begin(&txn);
+    if(mode == OLEDC_MODE_HORIZONTAL){
+        /* Full window again so the driver's page writes are not clipped */
+        oledc_window(&txn, 0, 127, 0, 7);
+    }
+    oledc_set_mode(&txn, OLEDC_MODE_PAGE);
+    oledc_send(&txn);
+}
+
+void oledc_invalidate(){
+    mode = OLEDC_MODE_UNKNOWN;
+}
@@ -0,0 +1,67 @@
+#ifndef OLED_CMD_H_
+#define OLED_CMD_H_
+
+#include "hal.h"
+#include "oled_queue.h"
+
+/*
+ * OLED COMMAND BUILDER
+ * Packs addressing commands and pixel data of one draw operation into a
+ * single I2C transaction: every command is preceded by a 0x80 control byte
+ * (Co = 1) and the pixel data by a final 0x40. Addressing uses either the
+ * page mode cursor (0xB0 / 0x00 / 0x10) or the horizontal mode column/page
+ * window (0x21 / 0x22); the builder tracks the controller mode and only
+ * emits 0x20 when it has to change.
+ */
+
+/* Transaction overhead in bus bytes: address + (control, cmd) pairs + data control */
+#define OLEDC_CURSOR_OVERHEAD 8U
+#define OLEDC_WINDOW_OVERHEAD 14U
+#define OLEDC_MODE_SWITCH     4U
+
+typedef enum {
+    OLEDC_MODE_UNKNOWN = 0,
+    OLEDC_MODE_HORIZONTAL,
+    OLEDC_MODE_PAGE
+} oledc_mode_t;
+
+typedef struct {
+    uint8_t buf[OLEDQ_MAX_PAYLOAD + 1U]; // buf[0] is the first control byte
+    uint16_t len;
+    bool data;                            // Data phase started, no more commands
+    oledc_mode_t mode;                    // Controller mode once the transaction went out
+} oledc_txn_t;
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bus_bytes;  // Including the address byte of each transaction
+} oledc_stats_t;
+
+extern oledc_stats_t oledc_stats;
+
+void oledc_begin(oledc_txn_t *txn);
+
+void oledc_command(oledc_txn_t *txn, uint8_t cmd);
+
+void oledc_data(oledc_txn_t *txn, const uint8_t *data, uint32_t len);
+
+/* Page mode cursor at (page, column) */
+void oledc_cursor(oledc_txn_t *txn, uint8_t page, uint8_t column);
+
+/* Horizontal mode window, data then fills it row by row */
+void oledc_window(oledc_txn_t *txn, uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1);
+
+/* Queues the transaction and returns its size on the bus, 0 if the queue
+ * dropped it (the controller mode is then left as it was) */
+uint32_t oledc_send(oledc_txn_t *txn);
+
+/* Extra bytes needed to switch the controller to 'mode' */
+uint32_t oledc_switch_cost(oledc_mode_t mode);
+
+/* Restores page mode and the full window before the blocking driver draws */
+void oledc_page_mode();
+
+/* Forgets the mode, e.g. after the driver has reinitialized the controller */
+void oledc_invalidate();
+
+#endif /* OLED_CMD_H_ */
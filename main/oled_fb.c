@@ -0,0 +1,193 @@
+#include "hal.h"
+#include "oled.h"
+#include "oled_fb.h"
+#include "oled_queue.h"
+#include "oled_cmd.h"
+#include "trace.h"
+
+uint8_t fb[FB_PAGES][FB_COLUMNS];
+
+/* Changed column span per page, clean when dirty_lo > dirty_hi */
+static uint8_t dirty_lo[FB_PAGES] = {FB_COLUMNS - 1, FB_COLUMNS - 1, FB_COLUMNS - 1, FB_COLUMNS - 1,
+                                     FB_COLUMNS - 1, FB_COLUMNS - 1, FB_COLUMNS - 1, FB_COLUMNS - 1};
+static uint8_t dirty_hi[FB_PAGES] = {0};
+
+/* Set once driver text is on screen: the framebuffer no longer knows every lit pixel */
+static bool fb_untracked = 1;
+
+static bool scrolled = 0;     // A scroll went out, 'last_scroll' is valid
+static uint32_t last_scroll;  // hal_ticks() when the last scroll was queued
+
+static void fb_mark_clean(uint8_t page){
+    dirty_lo[page] = FB_COLUMNS - 1;
+    dirty_hi[page] = 0;
+}
+
+static void fb_mark_dirty(uint8_t page, uint8_t lo, uint8_t hi);
+
+static void fb_put(uint8_t page, uint8_t seg, uint8_t value){
+    if(fb[page][seg] == value) return;
+    fb[page][seg] = value;
+    fb_mark_dirty(page, seg, seg);
+}
+
+static void fb_mark_dirty(uint8_t page, uint8_t lo, uint8_t hi){
+    if(dirty_lo[page] > dirty_hi[page]){
+        dirty_lo[page] = lo;
+        dirty_hi[page] = hi;
+    } else {
+        if(lo < dirty_lo[page]) dirty_lo[page] = lo;
+        if(hi > dirty_hi[page]) dirty_hi[page] = hi;
+    }
+}
+
+void fb_reset(){
+    if(fb_untracked){
+        /* Unknown content on screen: full clear through the driver */
+        oledc_page_mode();
+        oledq_wait();
+        resetOLED();
+        for(uint8_t p = 0; p < FB_PAGES; p++){
+            for(uint8_t c = 0; c < FB_COLUMNS; c++) fb[p][c] = 0;
+            fb_mark_clean(p);
+        }
+        fb_untracked = 0;
+        return;
+    }
+    /* Only the lit spans need to be blanked */
+    for(uint8_t p = 0; p < FB_PAGES; p++){
+        for(uint8_t c = 0; c < FB_COLUMNS; c++) fb_put(p, c, 0);
+    }
+    fb_flush();
+}
+
+void fb_draw(uint8_t page, uint8_t seg, const uint8_t *data, uint32_t len){
+    for(uint32_t i = 0; i < len && page < FB_PAGES; i++){
+        fb_put(page, seg, data[i]);
+        if(++seg == FB_COLUMNS){
+            seg = 0;
+            page++;
+        }
+    }
+}
+
+void fb_clear_area(uint8_t page, uint8_t seg, uint32_t len){
+    for(uint32_t i = 0; i < len && page < FB_PAGES; i++){
+        fb_put(page, seg, 0);
+        if(++seg == FB_COLUMNS){
+            seg = 0;
+            page++;
+        }
+    }
+}
+
+void fb_scroll_left(uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1){
+    fb_flush();
+
+    /* The display only follows if nothing in the window is still waiting to go out */
+    bool scroll = FB_HW_SCROLL;
+    for(uint8_t p = page0; p <= page1; p++){
+        if(dirty_lo[p] <= dirty_hi[p]) scroll = 0;
+    }
+    uint32_t gap = FB_SCROLL_GAP_MS * (HAL_TIMER_CLOCK_HZ / 1000U);
+    if(scroll && scrolled && hal_ticks() - last_scroll < gap) scroll = 0; // Too soon for the controller
+    if(scroll) scroll = oledq_reserve(1U);
+
+    for(uint8_t p = page0; p <= page1; p++){
+        uint8_t first = fb[p][col0];
+        for(uint8_t c = col0; c < col1; c++) fb[p][c] = fb[p][c + 1U];
+        fb[p][col1] = first;
+        if(!scroll) fb_mark_dirty(p, col0, col1);
+    }
+    if(!scroll) return;
+
+    /* Left scroll by one column: dummy, start page, dummy, end page, dummy, start and end column */
+    oledc_txn_t txn;
+    oledc_begin(&txn);
+    oledc_command(&txn, 0x2D);
+    oledc_command(&txn, 0x00);
+    oledc_command(&txn, page0);
+    oledc_command(&txn, 0x01);
+    oledc_command(&txn, page1);
+    oledc_command(&txn, 0x00);
+    oledc_command(&txn, col0);
+    oledc_command(&txn, col1);
+    if(!oledc_send(&txn)){
+        for(uint8_t p = page0; p <= page1; p++) fb_mark_dirty(p, col0, col1);
+        return;
+    }
+    scrolled = 1;
+    last_scroll = hal_ticks();
+}
+
+static uint32_t fb_flush_frame(){
+    uint32_t dirty_pages = 0;
+    uint32_t page_cost = 0;
+    uint8_t page0 = FB_PAGES, page1 = 0;
+    uint8_t col0 = FB_COLUMNS - 1, col1 = 0;
+    for(uint8_t p = 0; p < FB_PAGES; p++){
+        if(dirty_lo[p] > dirty_hi[p]) continue;
+        dirty_pages++;
+        page_cost += OLEDC_CURSOR_OVERHEAD + dirty_hi[p] - dirty_lo[p] + 1U;
+        if(page0 == FB_PAGES) page0 = p;
+        page1 = p;
+        if(dirty_lo[p] < col0) col0 = dirty_lo[p];
+        if(dirty_hi[p] > col1) col1 = dirty_hi[p];
+    }
+    if(dirty_pages == 0) return 0;
+
+    /* One window over the bounding box, or one cursor transaction per dirty page: whichever is smaller */
+    uint32_t rect_len = (uint32_t)(col1 - col0 + 1U) * (page1 - page0 + 1U);
+    uint32_t rect_cost = OLEDC_WINDOW_OVERHEAD + oledc_switch_cost(OLEDC_MODE_HORIZONTAL) + rect_len;
+    page_cost += oledc_switch_cost(OLEDC_MODE_PAGE);
+    bool use_window = (rect_cost < page_cost) && (rect_cost <= OLEDQ_MAX_PAYLOAD);
+
+    /* Whole frame or nothing: a deferred frame stays dirty and goes out with the next flush */
+    if(!oledq_reserve(use_window ? 1U : dirty_pages)) return 0;
+
+    oledc_txn_t txn;
+    uint32_t bytes = 0;
+    if(use_window){
+        oledc_begin(&txn);
+        oledc_window(&txn, col0, col1, page0, page1);
+        for(uint8_t p = page0; p <= page1; p++){
+            oledc_data(&txn, &fb[p][col0], col1 - col0 + 1U);
+            fb_mark_clean(p);
+        }
+        return oledc_send(&txn);
+    }
+    for(uint8_t p = page0; p <= page1; p++){
+        if(dirty_lo[p] > dirty_hi[p]) continue;
+        oledc_begin(&txn);
+        oledc_cursor(&txn, p, dirty_lo[p]);
+        oledc_data(&txn, &fb[p][dirty_lo[p]], dirty_hi[p] - dirty_lo[p] + 1U);
+        bytes += oledc_send(&txn);
+        fb_mark_clean(p);
+    }
+    return bytes;
+}
+
+uint32_t fb_flush(){
+    TRACE_BEGIN(TRACE_FB_FLUSH);
+    uint32_t bytes = fb_flush_frame();
+    TRACE_END(TRACE_FB_FLUSH);
+    return bytes;
+}
+
+void fb_text(uint8_t page, uint8_t seg, char *text){
+    fb_flush();
+    oledc_page_mode();
+    oledq_wait(); // The driver writes to the bus directly
+    fb_untracked = 1;
+    setPage(page);
+    setSeg(seg);
+    printfOLED(text);
+}
+
+void fb_var(char *format, uint32_t value, uint8_t seg, uint8_t page){
+    fb_flush();
+    oledc_page_mode();
+    oledq_wait();
+    fb_untracked = 1;
+    printVar(format, value, 0, seg, page);
+}
@@ -0,0 +1,50 @@
+#ifndef OLED_FB_H_
+#define OLED_FB_H_
+
+#include "hal.h"
+#include "oled.h"
+
+/*
+ * OLED FRAMEBUFFER
+ * RAM copy of the 128x64 display (8 pages of 128 columns). Drawing only
+ * updates the buffer and records the changed column span of each page;
+ * fb_flush() then queues a single transaction per dirty page, or one
+ * window transaction for the whole frame when that is smaller.
+ * Text is still rendered by the driver font (fb_text/fb_var), so those
+ * cells are not tracked and the next fb_reset() falls back to resetOLED().
+ */
+
+#define FB_PAGES   8U
+#define FB_COLUMNS 128U
+
+/* The controller has the one-column content scroll (0x2C/0x2D, SSD1306
+ * rev 1.6 and later). Without it fb_scroll_left() redraws the window. */
+#define FB_HW_SCROLL 1
+#define FB_SCROLL_GAP_MS 30U
+
+extern uint8_t fb[FB_PAGES][FB_COLUMNS];
+
+/* Blanks the display and the framebuffer */
+void fb_reset();
+
+/* Copies 'len' bytes at (page, seg); data running past column 127 continues on the next page */
+void fb_draw(uint8_t page, uint8_t seg, const uint8_t *data, uint32_t len);
+
+void fb_clear_area(uint8_t page, uint8_t seg, uint32_t len);
+
+/* Shifts a window one column to the left, on the display and in the
+ * framebuffer alike: one 0x2D command instead of resending the window.
+ * The column leaving at col0 comes back in at col1. The controller wants
+ * two frames (~30 ms) between scrolls: one queued sooner than
+ * FB_SCROLL_GAP_MS after the previous one marks the window dirty instead. */
+void fb_scroll_left(uint8_t page0, uint8_t page1, uint8_t col0, uint8_t col1);
+
+/* Sends the changed columns as one transaction per draw (see oled_cmd), returns the bytes on the bus */
+uint32_t fb_flush();
+
+/* Driver-rendered text at (page, seg) */
+void fb_text(uint8_t page, uint8_t seg, char *text);
+
+void fb_var(char *format, uint32_t value, uint8_t seg, uint8_t page);
+
+#endif /* OLED_FB_H_ */
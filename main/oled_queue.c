@@ -0,0 +1,94 @@
+#include "hal.h"
+#include "oled_queue.h"
+
+typedef struct {
+    uint8_t control;
+    uint16_t len;
+    uint8_t payload[OLEDQ_MAX_PAYLOAD];
+} oledq_desc_t;
+
+oledq_stats_t oledq_stats;
+
+static oledq_desc_t queue[OLEDQ_DEPTH];
+static volatile uint8_t head = 0;   // Descriptor in flight (or next to send)
+static volatile uint8_t count = 0;
+static volatile bool in_flight = 0;
+static oledq_policy_t policy = OLEDQ_POLICY_BLOCK;
+static oledq_callback_t callback = NULL;
+
+static void oledq_start();
+
+/* Completion interrupt: retire the descriptor and start the next one */
+static void oledq_done(){
+    head = (head + 1U) % OLEDQ_DEPTH;
+    count--;
+    in_flight = 0;
+    oledq_stats.completed++;
+    if(count > 0){
+        oledq_start();
+    } else if(callback){
+        callback();
+    }
+}
+
+static void oledq_start(){
+    oledq_desc_t *desc = &queue[head];
+    in_flight = 1;
+    hal_i2c_write_async(desc->control, desc->payload, desc->len, oledq_done);
+}
+
+void oledq_set_policy(oledq_policy_t new_policy){
+    policy = new_policy;
+}
+
+void oledq_set_callback(oledq_callback_t new_callback){
+    callback = new_callback;
+}
+
+bool oledq_push(uint8_t control, const uint8_t *payload, uint32_t len){
+    while(len > 0){
+        uint32_t chunk = (len > OLEDQ_MAX_PAYLOAD) ? OLEDQ_MAX_PAYLOAD : len;
+
+        if(count == OLEDQ_DEPTH){
+            if(policy == OLEDQ_POLICY_DROP){
+                oledq_stats.dropped++;
+                return 0;
+            }
+            while(count == OLEDQ_DEPTH) hal_idle();
+        }
+
+        oledq_desc_t *desc = &queue[(head + count) % OLEDQ_DEPTH];
+        desc->control = control;
+        desc->len = (uint16_t)chunk;
+        for(uint32_t i = 0; i < chunk; i++) desc->payload[i] = payload[i];
+
+        hal_irq_disable();
+        count++;
+        oledq_stats.enqueued++;
+        if(count > oledq_stats.max_depth) oledq_stats.max_depth = count;
+        if(!in_flight) oledq_start();
+        hal_irq_enable();
+
+        payload += chunk;
+        len -= chunk;
+    }
+    return 1;
+}
+
+bool oledq_reserve(uint32_t slots){
+    if(OLEDQ_DEPTH - count >= slots) return 1;
+    if(policy == OLEDQ_POLICY_BLOCK){
+        while(OLEDQ_DEPTH - count < slots) hal_idle();
+        return 1;
+    }
+    oledq_stats.frames_dropped++;
+    return 0;
+}
+
+bool oledq_busy(){
+    return count > 0;
+}
+
+void oledq_wait(){
+    while(count > 0) hal_idle();
+}
@@ -0,0 +1,56 @@
+#ifndef OLED_QUEUE_H_
+#define OLED_QUEUE_H_
+
+#include "hal.h"
+
+/*
+ * OLED TRANSFER QUEUE
+ * Non-blocking queue of command/data descriptors for the display. Payloads
+ * are copied into the descriptor, then drained one I2C transfer at a time by
+ * LPI2C2 + EDMA in the background (hal_i2c_write_async). Under the DROP
+ * policy a full queue rejects new work instead of waiting, for screens that
+ * redraw periodically anyway and must keep polling their inputs.
+ */
+
+#define OLEDQ_DEPTH       16U
+#define OLEDQ_MAX_PAYLOAD 256U
+
+#define OLEDQ_COMMAND     0x00U
+#define OLEDQ_DATA        0x40U
+#define OLEDQ_TRANSACTION 0x80U // Co = 1: the payload interleaves control bytes
+
+/* What happens to a new descriptor when all slots are in use */
+typedef enum {
+    OLEDQ_POLICY_BLOCK = 0, // Wait (hal_idle) until a slot frees up
+    OLEDQ_POLICY_DROP       // Reject the descriptor and count it
+} oledq_policy_t;
+
+typedef struct {
+    uint32_t enqueued;
+    uint32_t completed;
+    uint32_t dropped;         // Descriptors rejected by the DROP policy
+    uint32_t frames_dropped;  // Frames deferred by oledq_reserve() failing
+    uint32_t max_depth;
+} oledq_stats_t;
+
+typedef void (*oledq_callback_t)();
+
+extern oledq_stats_t oledq_stats;
+
+void oledq_set_policy(oledq_policy_t policy);
+
+/* Called from the completion interrupt each time the queue runs empty */
+void oledq_set_callback(oledq_callback_t callback);
+
+/* Queues a command or data payload, returns 0 if it was dropped */
+bool oledq_push(uint8_t control, const uint8_t *payload, uint32_t len);
+
+/* Returns 1 if 'slots' descriptors fit right now; counts a dropped frame otherwise */
+bool oledq_reserve(uint32_t slots);
+
+bool oledq_busy();
+
+/* Idles until every queued transfer has gone out, e.g. before using the blocking driver */
+void oledq_wait();
+
+#endif /* OLED_QUEUE_H_ */
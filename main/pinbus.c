@@ -0,0 +1,10 @@
+#include "hal.h"
+#include "pinbus.h"
+
+uint8_t pinbus_read(const pinbus_t *bus){
+    return bus->gather(hal_gpio_port_read(bus->port));
+}
+
+uint8_t pinbus_gather(const pinbus_t *bus, uint32_t pdir){
+    return bus->gather(pdir);
+}
@@ -0,0 +1,44 @@
+#ifndef PINBUS_H_
+#define PINBUS_H_
+
+#include "hal.h"
+
+/*
+ * PARALLEL INPUT BUS
+ * Eight pins of one port read as one byte: a single PDIR snapshot, so all
+ * bits come from the same instant and cannot tear while a switch moves.
+ * The pin-to-bit mapping is given once, as pin macros, and PINBUS_DEFINE
+ * turns it into a gather function of constant shifts and masks; any pins
+ * of the port, in any order, work the same way.
+ */
+
+typedef struct {
+    uint8_t port;
+    uint32_t mask;                     // Port pins that belong to the bus
+    uint8_t (*gather)(uint32_t pdir);  // Port snapshot -> bus value
+} pinbus_t;
+
+#define PINBUS_BIT(pdir, pin, bit) ((((pdir) >> (pin)) & 1UL) << (bit))
+
+/* Defines 'name', a bus on 'port' whose bit i is pin p<i> */
+#define PINBUS_DEFINE(name, port, p0, p1, p2, p3, p4, p5, p6, p7) \
+    static uint8_t name##_gather(uint32_t pdir){ \
+        return (uint8_t)(PINBUS_BIT(pdir, p0, 0) | PINBUS_BIT(pdir, p1, 1) | \
+                         PINBUS_BIT(pdir, p2, 2) | PINBUS_BIT(pdir, p3, 3) | \
+                         PINBUS_BIT(pdir, p4, 4) | PINBUS_BIT(pdir, p5, 5) | \
+                         PINBUS_BIT(pdir, p6, 6) | PINBUS_BIT(pdir, p7, 7)); \
+    } \
+    static const pinbus_t name = { \
+        (port), \
+        (1UL << (p0)) | (1UL << (p1)) | (1UL << (p2)) | (1UL << (p3)) | \
+        (1UL << (p4)) | (1UL << (p5)) | (1UL << (p6)) | (1UL << (p7)), \
+        name##_gather, \
+    }
+
+/* Reads the bus in one port access */
+uint8_t pinbus_read(const pinbus_t *bus);
+
+/* Bus value from a port snapshot taken by the caller, e.g. shared with other pins */
+uint8_t pinbus_gather(const pinbus_t *bus, uint32_t pdir);
+
+#endif /* PINBUS_H_ */
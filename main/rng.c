@@ -0,0 +1,70 @@
+#include "hal.h"
+#include "rng.h"
+
+static uint32_t state[4] = {0x9E3779B9U, 0x243F6A88U, 0xB7E15162U, 0x6A09E667U}; // Used until seeded
+
+static uint32_t rotl(uint32_t x, uint32_t k){
+    return (x << k) | (x >> (32U - k));
+}
+
+static uint64_t splitmix64(uint64_t *x){
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(uint64_t seed){
+    uint64_t a = splitmix64(&seed);
+    uint64_t b = splitmix64(&seed);
+    state[0] = (uint32_t)a;
+    state[1] = (uint32_t)(a >> 32);
+    state[2] = (uint32_t)b;
+    state[3] = (uint32_t)(b >> 32);
+}
+
+uint32_t rng_next(){
+    uint32_t result = rotl(state[1] * 5U, 7U) * 9U;
+    uint32_t t = state[1] << 9;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 11U);
+    return result;
+}
+
+uint32_t rng_below(uint32_t bound){
+    uint64_t m = (uint64_t)rng_next() * bound;
+    uint32_t low = (uint32_t)m;
+    if(low < bound){
+        /* Only now is the rejection threshold 2^32 mod bound worth a division */
+        uint32_t threshold = (0U - bound) % bound;
+        while(low < threshold){
+            m = (uint64_t)rng_next() * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+void rng_fill(uint32_t *out, uint32_t count){
+    /* Local copy of the state keeps it in registers for the whole batch */
+    uint32_t s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
+    for(uint32_t i = 0; i < count; i++){
+        out[i] = rotl(s1 * 5U, 7U) * 9U;
+        uint32_t t = s1 << 9;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 11U);
+    }
+    state[0] = s0;
+    state[1] = s1;
+    state[2] = s2;
+    state[3] = s3;
+}
@@ -0,0 +1,26 @@
+#ifndef RNG_H_
+#define RNG_H_
+
+#include "hal.h"
+
+/*
+ * RANDOM NUMBERS
+ * xoshiro128** (Blackman/Vigna): 128-bit state, period 2^128 - 1, four
+ * 32-bit words so every step is a handful of single-cycle M33 operations.
+ * The seed is spread over the state with SplitMix64, so any seed, even 0,
+ * gives a usable state. Bounded values use Lemire's multiply-and-reject
+ * method: no division on the fast path and no modulo bias.
+ * Not for cryptographic use.
+ */
+
+void rng_seed(uint64_t seed);
+
+uint32_t rng_next();
+
+/* Uniform in [0, bound), bound > 0 */
+uint32_t rng_below(uint32_t bound);
+
+/* Writes 'count' raw 32-bit numbers, for callers that want a batch */
+void rng_fill(uint32_t *out, uint32_t count);
+
+#endif /* RNG_H_ */
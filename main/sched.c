@@ -0,0 +1,46 @@
+#include "hal.h"
+#include "input.h"
+#include "sched.h"
+
+void sched_run(const sched_task_t *tasks, uint32_t count, input_button_t until){
+    uint32_t buttons = (until != SCHED_FOREVER) ? INPUT_MASK(until) : 0U;
+    for(uint32_t i = 0; i < count; i++) buttons |= INPUT_MASK(tasks[i].button);
+
+    while(1){
+        input_event_t press;
+        if(input_take_first(buttons, &press)){
+            if(press.button == until) return;
+            for(uint32_t i = 0; i < count; i++){
+                if(tasks[i].button == press.button){
+                    tasks[i].run();
+                    break;
+                }
+            }
+            continue;
+        }
+
+        for(uint32_t button = 0; button < INPUT_BUTTONS; button++){
+            if(!(buttons & INPUT_MASK(button))) input_discard((input_button_t)button);
+        }
+
+        hal_irq_disable();
+        while(!input_ready()){
+            hal_sleep();
+            /* Let the pending handler run before looking at the ring again */
+            hal_irq_enable();
+            hal_irq_disable();
+        }
+        hal_irq_enable();
+    }
+}
+
+void sched_wait(volatile uint32_t *flag){
+    hal_irq_disable();
+    while(!*flag){
+        hal_sleep();
+        hal_irq_enable();
+        hal_irq_disable();
+    }
+    *flag = 0;
+    hal_irq_enable();
+}
@@ -0,0 +1,31 @@
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include "hal.h"
+#include "input.h"
+
+/*
+ * COOPERATIVE SCHEDULER
+ * Menus are tables of tasks, each one released by a button press from the
+ * input event ring. sched_run() sleeps in WFI until an event arrives, then
+ * runs the task of the oldest press to completion. The ring is
+ * checked with interrupts masked, so a press that arrives just before the
+ * core goes to sleep still wakes it. Idle time and wake-ups are accounted
+ * in hal_stats.
+ */
+
+#define SCHED_FOREVER INPUT_BUTTONS // No button ends the menu
+
+typedef struct {
+    input_button_t button;
+    void (*run)();
+} sched_task_t;
+
+/* Dispatches 'tasks' in the order their buttons were pressed until 'until'
+ * is pressed. Presses that neither a task nor 'until' handle are discarded. */
+void sched_run(const sched_task_t *tasks, uint32_t count, input_button_t until);
+
+/* Sleeps until '*flag' is set by an interrupt handler, then clears it */
+void sched_wait(volatile uint32_t *flag);
+
+#endif /* SCHED_H_ */
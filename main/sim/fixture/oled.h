@@ -0,0 +1,45 @@
+#ifndef OLED_H_
+#define OLED_H_
+
+/*
+ * Fixture standing in for the project's oled.h in the host build: the same
+ * entry points and table names, with the tables defined in oled_fixture.c.
+ * Kept in the repository so that simulator runs and benchmark baselines are
+ * reproducible from a plain checkout; build with -I<path to oled.h> instead
+ * to see the real font and menus.
+ */
+
+#include <stdint.h>
+
+#define OLED_FIXTURE 1
+
+#define OLED_CMD  0U
+#define OLED_DATA 1U
+
+extern const char font[10][6];
+
+extern const char frame1[42];
+extern const char frame2[80];
+extern const char frame3[100];
+extern const char frame4[38];
+extern const char frame5[32];
+extern const char frame6[94];
+extern const char frame7[110];
+extern const char frame8[60];
+extern const char frame9[236];
+extern const char frame10[84];
+extern const char frame11[92];
+extern const char frame12[38];
+extern const char frame13[56];
+extern const char frame14[88];
+extern const char frame15[100];
+
+void initOLED();
+void resetOLED();
+void sendOLED(uint8_t *data, uint32_t len, uint8_t type);
+void setPage(uint8_t page);
+void setSeg(uint8_t seg);
+void printfOLED(char *text);
+void printVar(char *format, uint32_t value, uint8_t line, uint8_t seg, uint8_t page);
+
+#endif /* OLED_H_ */
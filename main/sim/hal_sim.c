@@ -0,0 +1,434 @@
+#ifdef HOST_SIM
+
+#include "sim.h"
+
+/* Host backend: virtual GPIO, ADC and CTIMER0 on a virtual cycle clock */
+
+#define SIM_MAX_EVENTS 64U
+#define SIM_ADC_CHANNELS 0x40U
+
+typedef struct {
+    uint64_t cycle;
+    sim_event_fn fn;
+} sim_event_t;
+
+uint64_t sim_cycles = 0;
+
+static uint32_t sim_ports[HAL_PORT_COUNT];
+
+static sim_event_t sim_events[SIM_MAX_EVENTS];
+static uint32_t sim_event_count = 0;
+
+static const uint16_t *adc_script[SIM_ADC_CHANNELS];
+static uint32_t adc_script_len[SIM_ADC_CHANNELS];
+static uint32_t adc_script_pos[SIM_ADC_CHANNELS];
+static uint32_t adc_noise = 0x12345678U;
+static bool adc_stuck[SIM_ADC_CHANNELS];
+static uint16_t adc_last[SIM_ADC_CHANNELS];
+
+static bool trng_present = 0;
+static uint32_t trng_state = 0x2545F491U;
+
+/* Transfer started by hal_i2c_write_async(), applied to the display when it completes */
+static uint8_t i2c_control;
+static const uint8_t *i2c_data;
+static uint32_t i2c_len;
+static hal_i2c_callback_t i2c_done;
+
+/* Write started by hal_uart_write_async() */
+static FILE *uart_capture = NULL;
+static hal_uart_callback_t uart_done;
+static const char *uart_input = "";  // Bytes not yet taken by hal_uart_read()
+
+/* Background scan started by hal_adc_scan_start() */
+static bool scan_running = 0;
+static uint64_t scan_trigger;  // Cycle of the CTIMER1 edge that started the pending scan
+static uint32_t scan_period;
+static hal_adc_scan_channel_t scan_channels[16];
+static uint64_t scan_cycles;   // Conversion time of one scan
+static uint32_t *scan_ring;
+static uint32_t scan_count;
+static uint32_t scan_ring_scans;
+static uint32_t scan_slot;
+static hal_adc_scan_callback_t scan_done;
+
+/* GPIO stream started by hal_gpio_stream_start(), modelled per pass: the
+ * slot writes themselves cost no CPU and the ring pins are not traced */
+static bool stream_running = 0;
+static uint64_t stream_base;    // Cycle at which the first pass started
+static uint64_t stream_pass;    // Cycles per pass
+static uint64_t stream_switch;  // Pass boundary of the queued frame
+static const uint32_t *stream_frame;
+static const uint32_t *stream_pending;
+static hal_gpio_stream_callback_t stream_started;
+
+/* CTIMER0 model: the counter is (sim_cycles - timer_base) while running */
+static bool timer_running = 0;
+static uint64_t timer_base = 0;
+static uint32_t timer_period = 0;
+
+void sim_reset(){
+    sim_cycles = 0;
+    sim_event_count = 0;
+    timer_running = 0;
+    timer_period = 0;
+    scan_running = 0;
+    stream_running = 0;
+    stream_pending = NULL;
+    for(uint32_t i = 0; i < HAL_PORT_COUNT; i++) sim_ports[i] = 0;
+    for(uint32_t i = 0; i < SIM_ADC_CHANNELS; i++){
+        adc_script[i] = NULL;
+        adc_script_len[i] = 0;
+        adc_script_pos[i] = 0;
+        adc_stuck[i] = 0;
+    }
+    trng_present = 0;
+    sim_oled_reset();
+}
+
+/* Cycle at which CTIMER0 next reaches its match, or UINT64_MAX if stopped */
+static uint64_t timer_next_match(){
+    if(!timer_running || timer_period == 0) return UINT64_MAX;
+    uint64_t count = sim_cycles - timer_base;
+    if(count <= timer_period) return timer_base + timer_period;
+    /* Match lowered below the counter: it only fires again after the 32-bit wrap */
+    return timer_base + ((uint64_t)1 << 32) + timer_period;
+}
+
+void sim_advance(uint64_t cycles){
+    uint64_t target = sim_cycles + cycles;
+
+    while(1){
+        uint64_t match = timer_next_match();
+        uint64_t event = (sim_event_count > 0) ? sim_events[0].cycle : UINT64_MAX;
+        uint64_t next = (match < event) ? match : event;
+        if(next > target) break;
+
+        if(next > sim_cycles){
+            hal_stats[hal_module].cycles += next - sim_cycles;
+            sim_cycles = next;
+        }
+        if(match <= event){
+            timer_base = sim_cycles; // Reset on match
+            ctimer_match_callback(1U);
+        } else {
+            sim_event_fn fn = sim_events[0].fn;
+            sim_event_count--;
+            for(uint32_t i = 0; i < sim_event_count; i++) sim_events[i] = sim_events[i + 1];
+            fn();
+        }
+    }
+    hal_stats[hal_module].cycles += target - sim_cycles;
+    sim_cycles = target;
+}
+
+void sim_at(uint64_t cycle, sim_event_fn fn){
+    if(sim_event_count == SIM_MAX_EVENTS){
+        fprintf(stderr, "sim: event queue full\n");
+        exit(1);
+    }
+    uint32_t i = sim_event_count++;
+    while(i > 0 && sim_events[i - 1].cycle > cycle){
+        sim_events[i] = sim_events[i - 1];
+        i--;
+    }
+    sim_events[i].cycle = cycle;
+    sim_events[i].fn = fn;
+}
+
+void sim_gpio_set(uint8_t port, uint32_t pin, uint8_t value){
+    if(value) sim_ports[port] |= (1U << pin);
+    else sim_ports[port] &= ~(1U << pin);
+}
+
+uint8_t sim_gpio_get(uint8_t port, uint32_t pin){
+    return (sim_ports[port] >> pin) & 1U;
+}
+
+void sim_adc_stuck(uint8_t channel, bool stuck){
+    adc_stuck[channel] = stuck;
+}
+
+void sim_trng(bool present){
+    trng_present = present;
+}
+
+void sim_adc_script(uint8_t channel, const uint16_t *values, uint32_t count){
+    adc_script[channel] = values;
+    adc_script_len[channel] = count;
+    adc_script_pos[channel] = 0;
+}
+
+void sim_i2c_transaction(uint32_t len){
+    /* Address byte + control byte + payload */
+    hal_stats[hal_module].i2c_bytes += len + 2U;
+    sim_advance(SIM_I2C_OVERHEAD_CYCLES + (uint64_t)(len + 2U) * SIM_I2C_BYTE_CYCLES);
+}
+
+void sim_print_stats(FILE *out){
+    static const char *names[HAL_MOD_COUNT] = {"menu", "temperature", "light", "game", "leds"};
+    fprintf(out, "%-12s %14s %10s %10s %10s %8s %7s %8s\n", "module", "cycles", "i2c_bytes", "gpio_wr", "gpio_rd",
+            "adc", "idle", "current");
+    for(int i = 0; i < HAL_MOD_COUNT; i++){
+        uint32_t idle = hal_idle_permille((hal_module_t)i);
+        fprintf(out, "%-12s %14llu %10u %10u %10u %8u %5u.%u%% %4u.%umA\n", names[i],
+                (unsigned long long)hal_stats[i].cycles, hal_stats[i].i2c_bytes,
+                hal_stats[i].gpio_writes, hal_stats[i].gpio_reads, hal_stats[i].adc_conversions,
+                idle / 10U, idle % 10U, hal_current_ua((hal_module_t)i) / 1000U,
+                hal_current_ua((hal_module_t)i) % 1000U / 100U);
+    }
+}
+
+/* --- HAL --- */
+
+uint8_t hal_gpio_read(uint8_t port, uint32_t pin){
+    hal_stats[hal_module].gpio_reads++;
+    sim_advance(SIM_GPIO_CYCLES);
+    return sim_gpio_get(port, pin);
+}
+
+void hal_gpio_write(uint8_t port, uint32_t pin, uint8_t value){
+    hal_stats[hal_module].gpio_writes++;
+    sim_advance(SIM_GPIO_CYCLES);
+    sim_gpio_set(port, pin, value);
+}
+
+uint32_t hal_gpio_port_read(uint8_t port){
+    hal_stats[hal_module].gpio_reads++;
+    sim_advance(SIM_GPIO_CYCLES);
+    return sim_ports[port];
+}
+
+/* Edges are injected by the scenario, which calls the handler itself */
+void hal_gpio_edge_irq(uint8_t port, uint32_t pin, bool enable){
+}
+
+void hal_gpio_port_toggle(uint8_t port, uint32_t mask){
+    hal_stats[hal_module].gpio_writes++;
+    sim_advance(SIM_GPIO_CYCLES);
+    sim_ports[port] ^= mask;
+}
+
+void hal_gpio_port_clear(uint8_t port, uint32_t mask){
+    hal_stats[hal_module].gpio_writes++;
+    sim_advance(SIM_GPIO_CYCLES);
+    sim_ports[port] &= ~mask;
+}
+
+void hal_init(){
+}
+
+uint32_t hal_ticks(){
+    return (uint32_t)sim_cycles;
+}
+
+static uint32_t sim_adc_noise(){
+    adc_noise ^= adc_noise << 13;
+    adc_noise ^= adc_noise >> 17;
+    adc_noise ^= adc_noise << 5;
+    return adc_noise;
+}
+
+/* Scripted value plus conversion noise, which shrinks with the square root of
+ * the 2^averaging conversions averaged; unscripted channels float */
+static uint16_t sim_adc_sample(uint8_t channel, uint8_t averaging){
+    channel &= SIM_ADC_CHANNELS - 1U;
+    if(adc_script_len[channel] == 0){
+        if(!adc_stuck[channel]) adc_last[channel] = (uint16_t)sim_adc_noise();
+        return adc_last[channel];
+    }
+
+    int32_t value = adc_script[channel][adc_script_pos[channel]];
+    adc_script_pos[channel] = (adc_script_pos[channel] + 1U) % adc_script_len[channel];
+    int32_t amplitude = (int32_t)(SIM_ADC_NOISE >> (averaging / 2U));
+    value += (int32_t)(sim_adc_noise() % (uint32_t)(2 * amplitude + 1)) - amplitude;
+    if(value < 0) value = 0;
+    if(value > 0xFFFF) value = 0xFFFF;
+    return (uint16_t)value;
+}
+
+uint16_t hal_adc_read(uint8_t channel){
+    hal_stats[hal_module].adc_conversions++;
+    sim_advance(SIM_ADC_TRIGGER_CYCLES + SIM_ADC_CYCLES);
+    return sim_adc_sample(channel, 0);
+}
+
+void hal_adc_burst(uint8_t channel, uint16_t *out, uint32_t count){
+    for(uint32_t done = 0; done < count; done += HAL_ADC_BURST_LOOPS) sim_advance(SIM_ADC_TRIGGER_CYCLES);
+    for(uint32_t i = 0; i < count; i++){
+        sim_advance(SIM_ADC_CYCLES);
+        out[i] = sim_adc_sample(channel, 0);
+    }
+    hal_stats[hal_module].adc_conversions += count;
+}
+
+bool hal_trng_read(uint32_t *out, uint32_t count){
+    if(!trng_present) return 0;
+    for(uint32_t i = 0; i < count; i++){
+        sim_advance(SIM_TRNG_WORD_CYCLES);
+        trng_state ^= trng_state << 13;
+        trng_state ^= trng_state >> 17;
+        trng_state ^= trng_state << 5;
+        out[i] = trng_state;
+    }
+    return 1;
+}
+
+static void sim_adc_scan_event();
+
+/* Schedules the end of the scan started by the trigger edge at 'trigger' */
+static void sim_adc_scan_schedule(uint64_t trigger){
+    scan_trigger = trigger;
+    sim_at(trigger + scan_cycles, sim_adc_scan_event);
+}
+
+/* End of one scan: fill the ring slot as the DMA would and raise the callback.
+ * Events left over from a stopped or restarted scan no longer match scan_trigger. */
+static void sim_adc_scan_event(){
+    if(!scan_running || sim_cycles != scan_trigger + scan_cycles) return;
+    uint32_t *results = &scan_ring[scan_slot * scan_count];
+    for(uint32_t i = 0; i < scan_count; i++){
+        results[i] = (1U << 31) | ((i + 1U) << 24) | sim_adc_sample(scan_channels[i].channel, scan_channels[i].averaging);
+    }
+    uint32_t trigger = (uint32_t)scan_trigger;
+    scan_slot = (scan_slot + 1U) % scan_ring_scans;
+    hal_stats[hal_module].adc_conversions += scan_count;
+    sim_adc_scan_schedule(scan_trigger + scan_period);
+    if(scan_done) scan_done(results, scan_count, trigger);
+}
+
+void hal_adc_scan_start(const hal_adc_scan_channel_t *channels, uint32_t count, uint32_t *ring, uint32_t ring_scans,
+                        uint32_t period, hal_adc_scan_callback_t done){
+    scan_cycles = 0;
+    for(uint32_t i = 0; i < count; i++){
+        scan_channels[i] = channels[i];
+        scan_cycles += (uint64_t)SIM_ADC_CYCLES << channels[i].averaging;
+    }
+    scan_ring = ring;
+    scan_count = count;
+    scan_ring_scans = ring_scans;
+    scan_slot = 0;
+    scan_period = period;
+    scan_done = done;
+    scan_running = 1;
+    sim_adc_scan_schedule(sim_cycles + period / 2U); // First rising edge of the half-period toggle
+}
+
+void hal_adc_scan_stop(){
+    scan_running = 0;
+}
+
+/* Pass boundary with a frame queued, stale once the stream was stopped or restarted */
+static void sim_gpio_stream_event(){
+    if(!stream_running || !stream_pending || sim_cycles != stream_switch) return;
+    stream_frame = stream_pending;
+    stream_pending = NULL;
+    if(stream_started) stream_started();
+}
+
+void hal_gpio_stream_start(const uint8_t *ports, uint32_t port_count, const uint32_t *frame, uint32_t slots,
+                           uint32_t slot_ticks){
+    stream_running = 1;
+    stream_base = sim_cycles;
+    stream_pass = (uint64_t)slots * slot_ticks;
+    stream_frame = frame;
+    stream_pending = NULL;
+}
+
+void hal_gpio_stream_next(const uint32_t *frame, hal_gpio_stream_callback_t started){
+    stream_started = started;
+    stream_pending = frame;
+    stream_switch = stream_base + ((sim_cycles - stream_base) / stream_pass + 1U) * stream_pass;
+    sim_at(stream_switch, sim_gpio_stream_event);
+}
+
+void hal_gpio_stream_stop(){
+    stream_running = 0;
+    stream_pending = NULL;
+}
+
+void hal_timer_set_period(uint32_t ticks){
+    timer_period = ticks;
+}
+
+void hal_timer_start(){
+    if(!timer_running){
+        timer_running = 1;
+        timer_base = sim_cycles;
+    }
+}
+
+void hal_timer_stop(){
+    timer_running = 0;
+}
+
+static void sim_i2c_complete(){
+    sim_oled_write(i2c_control, i2c_data, i2c_len);
+    if(i2c_done) i2c_done();
+}
+
+void hal_i2c_init(){
+}
+
+void hal_i2c_write_async(uint8_t control, const uint8_t *data, uint32_t len, hal_i2c_callback_t done){
+    hal_stats[hal_module].i2c_bytes += len + 2U;
+    i2c_control = control;
+    i2c_data = data;
+    i2c_len = len;
+    i2c_done = done;
+    sim_advance(SIM_DMA_SETUP_CYCLES);
+    /* The bus runs in the background, the CPU only pays for the setup */
+    sim_at(sim_cycles + SIM_I2C_OVERHEAD_CYCLES + (uint64_t)(len + 2U) * SIM_I2C_BYTE_CYCLES, sim_i2c_complete);
+}
+
+void sim_uart_capture(FILE *out){
+    uart_capture = out;
+}
+
+void sim_uart_input(const char *text){
+    uart_input = text;
+}
+
+static void sim_uart_complete(){
+    if(uart_done) uart_done();
+}
+
+void hal_uart_init(){
+}
+
+void hal_uart_write_async(const uint8_t *data, uint32_t len, hal_uart_callback_t done){
+    if(uart_capture) fwrite(data, 1, len, uart_capture);
+    uart_done = done;
+    sim_advance(SIM_DMA_SETUP_CYCLES);
+    sim_at(sim_cycles + (uint64_t)len * SIM_UART_BYTE_CYCLES, sim_uart_complete);
+}
+
+bool hal_uart_read(uint8_t *byte){
+    if(*uart_input == '\0') return false;
+    *byte = (uint8_t)*uart_input++;
+    return true;
+}
+
+/* Interrupts only fire inside sim_advance(), nothing to mask */
+void hal_irq_disable(){
+}
+
+void hal_irq_enable(){
+}
+
+/* Jumps to the next timer match or event, which plays the role of the wake-up interrupt */
+void hal_sleep(){
+    uint64_t match = timer_next_match();
+    uint64_t event = (sim_event_count > 0) ? sim_events[0].cycle : UINT64_MAX;
+    uint64_t next = (match < event) ? match : event;
+    if(next == UINT64_MAX){
+        fprintf(stderr, "sim: idle with no pending timer or event at cycle %llu\n",
+                (unsigned long long)sim_cycles);
+        exit(1);
+    }
+    hal_stats[hal_module].idle_cycles += next - sim_cycles;
+    hal_stats[hal_module].wakeups++;
+    sim_advance(next - sim_cycles);
+}
+
+#endif /* HOST_SIM */
@@ -0,0 +1,209 @@
+#ifdef HOST_SIM
+
+#include "sim.h"
+#include "oled.h"
+
+/*
+ * In-memory SSD1306 replacing the LPI2C OLED driver in the host build.
+ * Implements the oled.h entry points used by the modules, keeps a copy of
+ * the display RAM and charges every transaction to the I2C statistics.
+ */
+
+#define OLED_INIT_COMMANDS 25U
+
+uint8_t sim_oled_ram[SIM_OLED_PAGES][SIM_OLED_COLUMNS];
+
+static uint8_t oled_page = 0;
+static uint8_t oled_column = 0;
+
+/* Addressing mode (0x20): 0 = horizontal, 2 = page; window from 0x21/0x22 */
+static uint8_t oled_mode = 2;
+static uint8_t col_start = 0, col_end = SIM_OLED_COLUMNS - 1;
+static uint8_t page_start = 0, page_end = SIM_OLED_PAGES - 1;
+
+/* Multi-byte command being collected */
+static uint8_t pending_cmd = 0;
+static uint8_t pending_args = 0;
+static uint8_t args[7];
+static uint8_t arg_count = 0;
+
+void sim_oled_reset(){
+    for(uint32_t p = 0; p < SIM_OLED_PAGES; p++){
+        for(uint32_t c = 0; c < SIM_OLED_COLUMNS; c++) sim_oled_ram[p][c] = 0;
+    }
+    oled_page = 0;
+    oled_column = 0;
+    oled_mode = 2;
+    col_start = 0;
+    col_end = SIM_OLED_COLUMNS - 1;
+    page_start = 0;
+    page_end = SIM_OLED_PAGES - 1;
+    pending_args = 0;
+}
+
+static void oled_write_byte(uint8_t value){
+    sim_oled_ram[oled_page][oled_column] = value;
+    if(oled_mode == 2){
+        /* Page addressing mode: the column wraps inside the current page */
+        oled_column = (oled_column + 1U) % SIM_OLED_COLUMNS;
+    } else if(oled_column == col_end){
+        oled_column = col_start;
+        oled_page = (oled_page == page_end) ? page_start : oled_page + 1U;
+    } else {
+        oled_column++;
+    }
+}
+
+static void oled_write_data(const uint8_t *data, uint32_t len){
+    for(uint32_t i = 0; i < len; i++) oled_write_byte(data[i]);
+}
+
+static void oled_execute(uint8_t cmd){
+    switch(cmd){
+    case 0x20:
+        oled_mode = args[0] & 0x03;
+        break;
+    case 0x21:
+        col_start = args[0] & 0x7F;
+        col_end = args[1] & 0x7F;
+        oled_column = col_start;
+        break;
+    case 0x22:
+        page_start = args[0] & 0x07;
+        page_end = args[1] & 0x07;
+        oled_page = page_start;
+        break;
+    case 0x2C:
+    case 0x2D:
+        /* One-column content scroll of pages B..D, columns F..G, rotating inside the window */
+        for(uint8_t p = args[1] & 0x07; p <= (args[3] & 0x07); p++){
+            uint8_t c0 = args[5] & 0x7F, c1 = args[6] & 0x7F;
+            if(cmd == 0x2D){
+                uint8_t first = sim_oled_ram[p][c0];
+                for(uint8_t c = c0; c < c1; c++) sim_oled_ram[p][c] = sim_oled_ram[p][c + 1U];
+                sim_oled_ram[p][c1] = first;
+            } else {
+                uint8_t last = sim_oled_ram[p][c1];
+                for(uint8_t c = c1; c > c0; c--) sim_oled_ram[p][c] = sim_oled_ram[p][c - 1U];
+                sim_oled_ram[p][c0] = last;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void oled_write_command(uint8_t cmd){
+    if(pending_args > 0){
+        args[arg_count++] = cmd;
+        if(arg_count == pending_args){
+            pending_args = 0;
+            oled_execute(pending_cmd);
+        }
+        return;
+    }
+    if(cmd == 0x21 || cmd == 0x22){
+        pending_cmd = cmd;
+        pending_args = 2;
+        arg_count = 0;
+    } else if(cmd == 0x2C || cmd == 0x2D){
+        pending_cmd = cmd;
+        pending_args = 7;
+        arg_count = 0;
+    } else if(cmd == 0x20 || cmd == 0x81 || cmd == 0x8D || cmd == 0xA8 || cmd == 0xD3 ||
+              cmd == 0xD5 || cmd == 0xD9 || cmd == 0xDA || cmd == 0xDB){
+        pending_cmd = cmd;
+        pending_args = 1;
+        arg_count = 0;
+    } else if(cmd <= 0x0F){
+        oled_column = (oled_column & 0xF0) | cmd;
+    } else if(cmd <= 0x1F){
+        oled_column = (uint8_t)(((cmd & 0x07) << 4) | (oled_column & 0x0F));
+    } else if(cmd >= 0xB0 && cmd <= 0xB7){
+        oled_page = cmd & 0x07;
+    }
+}
+
+/* Control byte: Co (bit 7) = one byte then another control byte, D/C (bit 6) = data */
+void sim_oled_write(uint8_t control, const uint8_t *data, uint32_t len){
+    uint32_t i = 0;
+    while(control & 0x80){
+        if(i >= len) return;
+        if(control & 0x40) oled_write_byte(data[i++]);
+        else oled_write_command(data[i++]);
+        if(i >= len) return;
+        control = data[i++];
+    }
+    if(control & 0x40){
+        oled_write_data(&data[i], len - i);
+    } else {
+        for(; i < len; i++) oled_write_command(data[i]);
+    }
+}
+
+void initOLED(){
+    sim_i2c_transaction(OLED_INIT_COMMANDS);
+    resetOLED();
+}
+
+void sendOLED(uint8_t *data, uint32_t len, uint8_t type){
+    sim_i2c_transaction(len);
+    if(type == OLED_DATA){
+        oled_write_data(data, len);
+    } else {
+        for(uint32_t i = 0; i < len; i++) oled_write_command(data[i]);
+    }
+}
+
+void setPage(uint8_t page){
+    uint8_t cmd = 0xB0 | (page & 0x07);
+    sendOLED(&cmd, 1, OLED_CMD);
+}
+
+void setSeg(uint8_t seg){
+    uint8_t cmd[2] = {(uint8_t)(seg & 0x0F), (uint8_t)(0x10 | (seg >> 4))};
+    sendOLED(cmd, 2, OLED_CMD);
+}
+
+void resetOLED(){
+    static uint8_t blank[SIM_OLED_COLUMNS];
+    for(uint8_t p = 0; p < SIM_OLED_PAGES; p++){
+        setPage(p);
+        setSeg(0);
+        sendOLED(blank, SIM_OLED_COLUMNS, OLED_DATA);
+    }
+    setPage(0);
+    setSeg(0);
+}
+
+/*
+ * Text is rendered with the digit glyphs from font[]; other characters only
+ * occupy their 6-column cell, the ASCII font lives in the board driver.
+ */
+void printfOLED(char *text){
+    static const uint8_t blank[6];
+    while(*text){
+        if(*text == '\n'){
+            setPage((uint8_t)(oled_page + 1U));
+            setSeg(0);
+        } else if(*text >= '0' && *text <= '9'){
+            sendOLED((uint8_t*)&font[*text - '0'][0], 6, OLED_DATA);
+        } else {
+            sendOLED((uint8_t*)blank, 6, OLED_DATA);
+        }
+        text++;
+    }
+}
+
+void printVar(char *format, uint32_t value, uint8_t line, uint8_t seg, uint8_t page){
+    char text[12];
+    (void)format; // The modules only print unsigned integers
+    (void)line;
+    snprintf(text, sizeof(text), "%lu", (unsigned long)value);
+    setPage(page);
+    setSeg(seg);
+    printfOLED(text);
+}
+
+#endif /* HOST_SIM */
@@ -0,0 +1,74 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+/*
+ * HOST SIMULATOR
+ * Virtual GPIO ports, scripted ADC channels, a CTIMER0 model driven by a
+ * virtual cycle clock and an in-memory SSD1306 (see oled_sim.c).
+ * Every HAL call charges an approximate cost to the clock, so the module
+ * loops can be profiled and regression-tested on Linux.
+ */
+
+#include "hal.h"
+
+#define SIM_MS(ms) ((uint64_t)(ms) * (HAL_TIMER_CLOCK_HZ / 1000U))
+
+/* Approximate costs in core cycles */
+#define SIM_GPIO_CYCLES          4U
+#define SIM_GPIO_IRQ_CYCLES      40U    // Edge to the PDIR read in the handler: entry, flag check, call
+#define SIM_ADC_CYCLES           225U   // ~1.5 us conversion
+#define SIM_I2C_BYTE_CYCLES      3375U  // 9 bits at 400 kHz
+#define SIM_I2C_OVERHEAD_CYCLES  750U   // START/STOP and driver setup per transaction
+#define SIM_DMA_SETUP_CYCLES     200U   // CPU cost of starting an EDMA transfer
+#define SIM_ADC_TRIGGER_CYCLES   60U    // Software trigger and result polling per hal_adc_read()/burst
+#define SIM_ADC_NOISE            256U   // +/- counts on a single scripted conversion
+#define SIM_UART_BYTE_CYCLES     13021U // 10 bits at 115200 baud
+#define SIM_TRNG_WORD_CYCLES     1500U  // ~10 us per 32-bit word once the TRNG is running
+
+#define SIM_OLED_PAGES   8U
+#define SIM_OLED_COLUMNS 128U
+
+typedef void (*sim_event_fn)();
+
+extern uint64_t sim_cycles;
+extern uint8_t sim_oled_ram[SIM_OLED_PAGES][SIM_OLED_COLUMNS];
+
+/* Clears the virtual hardware, clock and pending events */
+void sim_reset();
+
+/* Moves the virtual clock forward, firing timer matches and scheduled events on the way */
+void sim_advance(uint64_t cycles);
+
+/* Schedules a callback at an absolute virtual cycle (e.g. a button press) */
+void sim_at(uint64_t cycle, sim_event_fn fn);
+
+void sim_gpio_set(uint8_t port, uint32_t pin, uint8_t value);
+
+uint8_t sim_gpio_get(uint8_t port, uint32_t pin);
+
+/* Channel returns the scripted values in a loop; unscripted channels return noise */
+void sim_adc_script(uint8_t channel, const uint16_t *values, uint32_t count);
+
+/* Freezes an unscripted channel at its last value, e.g. a floating pin that got pulled */
+void sim_adc_stuck(uint8_t channel, bool stuck);
+
+/* Whether the virtual part has a hardware TRNG (off after sim_reset) */
+void sim_trng(bool present);
+
+/* Copies every byte sent on the debug UART to 'out', NULL to stop */
+void sim_uart_capture(FILE *out);
+
+/* Bytes the debug UART receives from the host, taken by hal_uart_read(); must stay valid until then */
+void sim_uart_input(const char *text);
+
+/* Charges one I2C transaction of 'len' payload bytes to the bus and the clock */
+void sim_i2c_transaction(uint32_t len);
+
+void sim_oled_reset();
+
+/* Applies one I2C write (control byte 0x00 = commands, 0x40 = data) to the display RAM */
+void sim_oled_write(uint8_t control, const uint8_t *data, uint32_t len);
+
+void sim_print_stats(FILE *out);
+
+#endif /* SIM_H_ */
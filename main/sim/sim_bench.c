@@ -0,0 +1,361 @@
+#if defined(HOST_SIM) && defined(SIM_BENCH)
+
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "oled.h"
+#include "oled_fb.h"
+#include "oled_queue.h"
+#include "oled_cmd.h"
+#include "input.h"
+#include "swtimer.h"
+#include "leds.h"
+#include "menu.h"
+#include "numfield.h"
+#include "rng.h"
+
+/*
+ * Host micro-benchmarks of the rendering, conversion and input paths.
+ * Each benchmark reports host ns per operation and, from the simulator
+ * counters, OLED bus bytes and GPIO register accesses per operation. With
+ * a baseline file, a benchmark slower than the baseline by more than the
+ * threshold, or one that puts more bytes on the bus or more GPIO accesses,
+ * is a regression and the exit status is 1.
+ *
+ * What the display benchmarks draw comes from the tables of oled.h, so
+ * their numbers only hold for the oled.h they were recorded with. The
+ * baseline carries a signature of its font and main menu frames; against
+ * a different one those benchmarks are shown but not compared.
+ *
+ *   hub_bench [-b baseline] [-t threshold %] [-s save]
+ */
+
+#define BENCH_REPEATS   9U     // Best of, against scheduler noise
+#define BENCH_SAMPLES   100000U // Most iterations of a benchmark timed one by one
+#define BENCH_THRESHOLD 10.0   // Default allowed ns/op increase in %
+#define BENCH_MAX       16U
+
+typedef struct {
+    const char *name;
+    uint32_t iterations;
+    void (*setup)();             // Before each repeat, not measured
+    void (*prepare)(uint32_t i); // Before each operation, not measured
+    void (*run)(uint32_t i);     // The operation
+    bool drain;                  // Waits for the OLED queue after each operation, not measured
+    bool display;                // Draws oled.h content, compared only against the same oled.h
+} bench_t;
+
+typedef struct {
+    char name[32];
+    double ns;
+    double bytes;
+    double gpio;
+} bench_result_t;
+
+/* Same as the board callback in main.c */
+void ctimer_match_callback(uint32_t flags){
+    swtimer_tick();
+}
+
+static double bench_clock(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint32_t bench_gpio_ops(){
+    uint32_t ops = 0;
+    for(uint32_t m = 0; m < HAL_MOD_COUNT; m++) ops += hal_stats[m].gpio_reads + hal_stats[m].gpio_writes;
+    return ops;
+}
+
+/* Fresh virtual hardware with a blank, tracked framebuffer */
+static void bench_reset(){
+    oledq_wait();
+    input_scan_stop();
+    sim_reset();
+    led_ring_init();
+    swtimer_init();
+    hal_set_module(HAL_MOD_MENU);
+    fb_reset();
+    oledq_wait();
+}
+
+/* --- DIGITS ---
+ * A counter stepping by one, as a slowly moving reading. digits_div is the
+ * loop the modules carried before numfield.c, kept as the reference: clear
+ * the field, then one glyph per digit found by division. */
+#define BENCH_DIGITS_SEG   95U
+#define BENCH_DIGITS_WIDTH 24U
+
+static void bench_digits_div(uint32_t i){
+    uint16_t value = (uint16_t)(1000U + i % 9000U);
+    fb_clear_area(0, BENCH_DIGITS_SEG, BENCH_DIGITS_WIDTH);
+    uint8_t seg = BENCH_DIGITS_SEG;
+    uint16_t div = 1;
+    while(value / div >= 10) div *= 10;
+    while(div > 0){
+        uint8_t digit = (value / div) % 10;
+        fb_draw(0, seg, (const uint8_t*)&font[digit][0], 6);
+        seg += 6;
+        div /= 10;
+    }
+    fb_flush();
+}
+
+static numfield_t bench_field;
+
+static void bench_digits_setup(){
+    bench_reset();
+    numfield_init(&bench_field, 0, BENCH_DIGITS_SEG, BENCH_DIGITS_WIDTH / NUMFIELD_CELL, 0);
+}
+
+static void bench_digits_field(uint32_t i){
+    numfield_set(&bench_field, (int32_t)(1000U + i % 9000U));
+    fb_flush();
+}
+
+/* --- MENU --- full main menu over a blank screen */
+static void bench_menu_prepare(uint32_t i){
+    fb_reset();
+    oledq_wait();
+}
+
+static void bench_menu(uint32_t i){
+    OLED_main_meniu();
+}
+
+/* --- LEDS --- ring off from a lit pattern */
+static void bench_leds_prepare(uint32_t i){
+    led_ring_write((uint8_t)(i | 1U));
+}
+
+static void bench_leds(uint32_t i){
+    resets_led();
+}
+
+/* --- RNG --- */
+static volatile uint32_t bench_sink;
+
+static void bench_rng_setup(){
+    rng_seed(0x0123456789ABCDEFULL);
+}
+
+static void bench_rng_next(uint32_t i){
+    bench_sink = rng_next();
+}
+
+static void bench_rng_below(uint32_t i){
+    bench_sink = rng_below(256U);
+}
+
+/* --- INPUT ---
+ * One 1 ms tick with only the input scan armed: a read per port, the DIP bus
+ * gather and the debounce of every sampled pin, while DIP1 and NAV left move.
+ * The events are taken as the menu loop would. */
+static void bench_input_setup(){
+    bench_reset();
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_A_LEFT_GPIO_PIN, 1); // NAV is active low
+    sim_gpio_set(HAL_PORT1, SHIELD_NAV_B_RIGHT_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_C_UP_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT0, SHIELD_NAV_D_DOWN_GPIO_PIN, 1);
+    input_scan_start();
+}
+
+static void bench_input(uint32_t i){
+    sim_gpio_set(HAL_PORT0, SHIELD_DIP_1_GPIO_PIN, (uint8_t)((i >> 4) & 1U));
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_A_LEFT_GPIO_PIN, (uint8_t)((i >> 5) & 1U));
+    swtimer_tick();
+    input_event_t event;
+    while(input_pop(&event)) bench_sink = event.button;
+}
+
+static const bench_t benches[] = {
+        {"digits_div",   20000U,   bench_reset,     NULL,                bench_digits_div, 1, 1},
+        {"digits_field", 20000U,   bench_digits_setup, NULL,             bench_digits_field, 1, 1},
+        {"main_menu",    2000U,    bench_reset,     bench_menu_prepare,  bench_menu,       1, 1},
+        {"resets_led",   100000U,  bench_reset,     bench_leds_prepare,  bench_leds,       0, 0},
+        {"rng_next",     1000000U, bench_rng_setup, NULL,                bench_rng_next,   0, 0},
+        {"rng_below256", 1000000U, bench_rng_setup, NULL,                bench_rng_below,  0, 0},
+        {"input_scan",   100000U,  bench_input_setup, NULL,              bench_input,      0, 0},
+};
+
+#define BENCH_COUNT (sizeof(benches) / sizeof(benches[0]))
+_Static_assert(sizeof(benches) / sizeof(benches[0]) <= BENCH_MAX, "raise BENCH_MAX");
+
+/* FNV-1a of the digit font and of the main menu as drawn on a blank screen */
+static uint32_t bench_oled_signature(){
+    uint32_t hash = 0x811C9DC5U;
+    bench_reset();
+    OLED_main_meniu();
+    oledq_wait();
+    for(uint32_t i = 0; i < sizeof(fb); i++){
+        hash = (hash ^ ((const uint8_t*)fb)[i]) * 0x01000193U;
+    }
+    for(uint32_t i = 0; i < sizeof(font); i++){
+        hash = (hash ^ ((const uint8_t*)font)[i]) * 0x01000193U;
+    }
+    bench_reset();
+    return hash;
+}
+
+static int bench_compare(const void *a, const void *b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Cost of reading the clock around one operation, taken off per-operation
+ * timings; the median, so that a preempted read does not push short
+ * operations below zero */
+static double bench_clock_overhead(){
+    static double reads[100000U];
+    for(uint32_t i = 0; i < 100000U; i++){
+        double t0 = bench_clock();
+        reads[i] = bench_clock() - t0;
+    }
+    qsort(reads, 100000U, sizeof(reads[0]), bench_compare);
+    return reads[100000U / 2U];
+}
+
+/* Batches the operations when nothing has to happen in between; otherwise
+ * times them one by one and averages the middle half, which an interrupt of
+ * the host cannot move and which is finer than the clock's 1 ns step */
+static bench_result_t bench_run(const bench_t *bench, double overhead){
+    static double samples[BENCH_SAMPLES];
+    bench_result_t result = {{0}, 1e300, 0, 0};
+    if((bench->prepare || bench->drain) && bench->iterations > BENCH_SAMPLES){
+        fprintf(stderr, "bench: %s times %u operations one by one, BENCH_SAMPLES is %u\n", bench->name,
+                bench->iterations, BENCH_SAMPLES);
+        exit(2);
+    }
+    snprintf(result.name, sizeof(result.name), "%s", bench->name);
+
+    for(uint32_t r = 0; r < BENCH_REPEATS; r++){
+        if(bench->setup) bench->setup();
+        uint32_t bytes = 0, gpio = 0;
+        double ns = 0;
+
+        if(!bench->prepare && !bench->drain){
+            uint32_t bytes0 = oledc_stats.bus_bytes, gpio0 = bench_gpio_ops();
+            double t0 = bench_clock();
+            for(uint32_t i = 0; i < bench->iterations; i++) bench->run(i);
+            ns = bench_clock() - t0;
+            bytes = oledc_stats.bus_bytes - bytes0;
+            gpio = bench_gpio_ops() - gpio0;
+        } else {
+            for(uint32_t i = 0; i < bench->iterations; i++){
+                if(bench->prepare) bench->prepare(i);
+                uint32_t bytes0 = oledc_stats.bus_bytes, gpio0 = bench_gpio_ops();
+                double t0 = bench_clock();
+                bench->run(i);
+                samples[i] = bench_clock() - t0 - overhead;
+                if(bench->drain) oledq_wait();
+                bytes += oledc_stats.bus_bytes - bytes0;
+                gpio += bench_gpio_ops() - gpio0;
+            }
+            qsort(samples, bench->iterations, sizeof(samples[0]), bench_compare);
+            uint32_t lo = bench->iterations / 4U, hi = bench->iterations - lo;
+            for(uint32_t i = lo; i < hi; i++) ns += samples[i];
+            ns = ns / (hi - lo) * bench->iterations;
+        }
+        if(ns / bench->iterations < result.ns) result.ns = ns / bench->iterations;
+        result.bytes = (double)bytes / bench->iterations;
+        result.gpio = (double)gpio / bench->iterations;
+    }
+    return result;
+}
+
+/* Lines of "name ns bytes gpio", '#' starts a comment; "# oled.h <signature>"
+ * gives the oled.h of the display benchmarks, 0 in 'signature' when missing */
+static uint32_t bench_load(const char *path, bench_result_t *out, uint32_t *signature){
+    FILE *file = fopen(path, "r");
+    if(!file){
+        fprintf(stderr, "bench: cannot read baseline %s\n", path);
+        exit(2);
+    }
+    char line[128];
+    uint32_t n = 0;
+    *signature = 0;
+    while(n < BENCH_MAX && fgets(line, sizeof(line), file)){
+        if(line[0] == '#'){
+            sscanf(line, "# oled.h %x", signature);
+            continue;
+        }
+        if(sscanf(line, "%31s %lf %lf %lf", out[n].name, &out[n].ns, &out[n].bytes, &out[n].gpio) == 4) n++;
+    }
+    fclose(file);
+    return n;
+}
+
+static void bench_save(const char *path, const bench_result_t *results, uint32_t count, uint32_t signature){
+    FILE *file = fopen(path, "w");
+    if(!file){
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        exit(2);
+    }
+    fprintf(file, "# name ns/op bus-bytes/op gpio-ops/op (hub_bench -s)\n");
+#ifdef OLED_FIXTURE
+    fprintf(file, "# oled.h %08X (FNV-1a of the font and main menu of main/sim/fixture/oled.h)\n", signature);
+#else
+    fprintf(file, "# oled.h %08X (FNV-1a of the font and main menu it was recorded with)\n", signature);
+#endif
+    for(uint32_t i = 0; i < count; i++){
+        fprintf(file, "%s %.2f %.2f %.2f\n", results[i].name, results[i].ns, results[i].bytes, results[i].gpio);
+    }
+    fclose(file);
+}
+
+int main(int argc, char **argv){
+    const char *baseline_path = NULL, *save_path = NULL;
+    double threshold = BENCH_THRESHOLD;
+    for(int a = 1; a + 1 < argc; a += 2){
+        if(strcmp(argv[a], "-b") == 0) baseline_path = argv[a + 1];
+        else if(strcmp(argv[a], "-t") == 0) threshold = atof(argv[a + 1]);
+        else if(strcmp(argv[a], "-s") == 0) save_path = argv[a + 1];
+    }
+
+    bench_result_t baseline[BENCH_MAX];
+    uint32_t base_signature = 0;
+    uint32_t baselines = baseline_path ? bench_load(baseline_path, baseline, &base_signature) : 0;
+    bench_result_t results[BENCH_COUNT];
+    uint32_t signature = bench_oled_signature();
+    double overhead = bench_clock_overhead();
+    uint32_t regressions = 0, skipped = 0;
+
+    printf("%-14s %10s %10s %8s  %s\n", "bench", "ns/op", "bytes/op", "gpio/op", baselines ? "vs baseline" : "");
+    for(uint32_t b = 0; b < BENCH_COUNT; b++){
+        results[b] = bench_run(&benches[b], overhead);
+        printf("%-14s %10.2f %10.2f %8.2f", results[b].name, results[b].ns, results[b].bytes, results[b].gpio);
+
+        const bench_result_t *base = NULL;
+        for(uint32_t i = 0; i < baselines; i++){
+            if(strcmp(baseline[i].name, results[b].name) == 0) base = &baseline[i];
+        }
+        if(base && benches[b].display && signature != base_signature){
+            printf("  (other oled.h)");
+            skipped++;
+        } else if(base){
+            double change = base->ns > 0 ? (results[b].ns / base->ns - 1.0) * 100.0 : 0.0;
+            bool slower = change > threshold;
+            bool costlier = results[b].bytes > base->bytes + 0.005 || results[b].gpio > base->gpio + 0.005;
+            printf("  %+6.1f %%%s%s", change, slower ? "  SLOWER" : "", costlier ? "  MORE BUS/GPIO" : "");
+            regressions += slower || costlier;
+        } else if(baselines){
+            printf("  (new)");
+        }
+        printf("\n");
+    }
+    oledq_wait();
+
+    if(save_path) bench_save(save_path, results, BENCH_COUNT, signature);
+    if(baselines){
+        printf("bench: %u regression(s) against %s, threshold %.1f %%\n", regressions, baseline_path, threshold);
+    }
+    if(skipped){
+        printf("bench: %u display bench(es) not compared, oled.h %08X, baseline recorded with %08X\n", skipped,
+               signature, base_signature);
+    }
+    return regressions ? 1 : 0;
+}
+
+#endif /* HOST_SIM && SIM_BENCH */
@@ -0,0 +1,41 @@
+#ifndef SIM_BOARD_H_
+#define SIM_BOARD_H_
+
+/*
+ * Stand-in for the board/pin_mux headers in the host build.
+ * Ports follow the shield wiring; pin numbers only need to be unique per port.
+ */
+
+/* GPIO0 */
+#define SHIELD_DIP_1_GPIO_PIN       14U
+#define SHIELD_DIP_2_GPIO_PIN       15U
+#define SHIELD_DIP_3_GPIO_PIN       16U
+#define SHIELD_DIP_4_GPIO_PIN       17U
+#define SHIELD_DIP_5_GPIO_PIN       20U
+#define SHIELD_DIP_6_GPIO_PIN       21U
+#define SHIELD_DIP_7_GPIO_PIN       22U
+#define SHIELD_DIP_8_GPIO_PIN       23U
+#define SHIELD_LED2_GPIO_PIN        24U
+#define SHIELD_LED3_GPIO_PIN        25U
+#define SHIELD_LED4_GPIO_PIN        26U
+#define SHIELD_NAV_D_DOWN_GPIO_PIN  27U
+
+/* GPIO1 */
+#define SHIELD_NAV_B_RIGHT_GPIO_PIN 22U
+
+/* GPIO2 */
+#define SHIELD_LED5_GPIO_PIN        0U
+#define SHIELD_LED6_GPIO_PIN        1U
+#define SHIELD_LED7_GPIO_PIN        6U
+#define SHIELD_LED8_GPIO_PIN        7U
+
+/* GPIO3 */
+#define SHIELD_NAV_A_LEFT_GPIO_PIN  0U
+#define SHIELD_NAV_C_UP_GPIO_PIN    1U
+#define SHIELD_ROTARY_1_GPIO_PIN    2U
+#define SHIELD_ROTARY_2_GPIO_PIN    3U
+
+/* GPIO4 */
+#define SHIELD_LED1_GPIO_PIN        1U
+
+#endif /* SIM_BOARD_H_ */
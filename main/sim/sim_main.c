@@ -0,0 +1,480 @@
+#if defined(HOST_SIM) && !defined(SIM_BENCH)
+
+#include <time.h>
+#include "sim.h"
+#include "oled.h"
+#include "oled_fb.h"
+#include "oled_queue.h"
+#include "oled_cmd.h"
+#include "adc_scan.h"
+#include "filter.h"
+#include "input.h"
+#include "swtimer.h"
+#include "leds.h"
+#include "encoder.h"
+#include "temperature.h"
+#include "light_intensity.h"
+#include "game.h"
+#include "rng.h"
+#include "entropy.h"
+#include "history.h"
+#include "trend.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "menu.h"
+
+/*
+ * Host profiling runner: plays a scripted scenario through every module and
+ * prints the per-module cycle, I2C and GPIO counters.
+ */
+
+static const uint16_t thermistor_script[] = {0x8000, 0x8010, 0x8020, 0x7FF0};
+static const uint16_t photodiode_script[] = {0x2000, 0x4000, 0x6000};
+static const uint16_t potentiometer_script[] = {0x1000, 0x1000, 0x4000, 0x8000, 0xF000};
+
+/* Same as the board callback in main.c */
+void ctimer_match_callback(uint32_t flags){
+    swtimer_tick();
+}
+
+/* Same as the board button interrupt handlers */
+static void press_exit(){
+    input_post(INPUT_BACK, INPUT_EDGE_PRESS);
+}
+
+static void press_sw2(){
+    input_post(INPUT_SW2, INPUT_EDGE_PRESS);
+}
+
+/* Clockwise quadrature, (A << 1) | B: 00 -> 10 -> 11 -> 01 */
+static const uint8_t quadrature[4] = {0, 2, 3, 1};
+static uint8_t encoder_phase = 0;
+
+static void encoder_move(int32_t dir){
+    encoder_phase = (uint8_t)((encoder_phase + dir) & 3U);
+    sim_gpio_set(HAL_PORT3, SHIELD_ROTARY_1_GPIO_PIN, quadrature[encoder_phase] >> 1);
+    sim_gpio_set(HAL_PORT3, SHIELD_ROTARY_2_GPIO_PIN, quadrature[encoder_phase] & 1U);
+}
+
+/* One count clockwise, with the edge interrupt of the board */
+static void encoder_step(){
+    encoder_move(1);
+    encoder_edge();
+}
+
+static void nav_left_press(){
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_A_LEFT_GPIO_PIN, 0);
+}
+
+static void nav_left_release(){
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_A_LEFT_GPIO_PIN, 1);
+}
+
+static void dip_set(){
+    sim_gpio_set(HAL_PORT0, SHIELD_DIP_1_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT0, SHIELD_DIP_3_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT0, SHIELD_DIP_8_GPIO_PIN, 1);
+}
+
+/* NAV buttons are active low */
+static void release_nav(){
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_A_LEFT_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT1, SHIELD_NAV_B_RIGHT_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT3, SHIELD_NAV_C_UP_GPIO_PIN, 1);
+    sim_gpio_set(HAL_PORT0, SHIELD_NAV_D_DOWN_GPIO_PIN, 1);
+}
+
+/* Lets the display traffic of the previous run drain before the hardware is reset */
+static void scenario_start(){
+    oledq_wait();
+    telemetry_stop(); // Sends out the rest of the previous run
+    input_scan_stop(); // Unhooked before the timer wheel is cleared
+    sim_reset();
+    led_ring_init(); // The ports came back low
+    swtimer_init();
+    input_scan_start();
+    telemetry_start();
+    adc_scan_start();
+    sim_advance(SIM_MS(1)); // First scans land before the module reads them
+}
+
+/* The trend graph of the last scenario as the display shows it, must match the framebuffer */
+static void check_trend(const char *name){
+    oledq_wait();
+    uint32_t mismatched = 0;
+    for(uint32_t p = TREND_PAGE0; p <= TREND_PAGE1; p++){
+        for(uint32_t c = TREND_COL0; c <= TREND_COL1; c++) mismatched += sim_oled_ram[p][c] != fb[p][c];
+    }
+    printf("trend %-11s %u scrolled (%u bus bytes each), %u redraws, %u bytes differ from the framebuffer\n", name,
+           trend_stats.scrolled, trend_stats.scrolled ? trend_stats.scroll_bytes / trend_stats.scrolled : 0U,
+           trend_stats.redraws, mismatched);
+    trend_stats = (trend_stats_t){0};
+}
+
+/* Window statistics that the sensor history kept over the last scenario */
+static void print_history(const char *name, adc_scan_channel_t sensor){
+    static const char *const tiers[HISTORY_TIERS] = {"minute", "hour", "day"};
+    for(uint32_t t = 0; t < HISTORY_TIERS; t++){
+        history_stats_t stats = history_stats(sensor, (history_tier_t)t);
+        printf("history %-11s %-6s %3u points, min %5u max %5u mean %5u variance %u\n", name, tiers[t],
+               stats.count, stats.min, stats.max, stats.mean, stats.variance);
+    }
+}
+
+static void run_temperature(){
+    scenario_start();
+    sim_adc_script(HAL_ADC_THERMISTOR, thermistor_script, 4);
+    sim_at(SIM_MS(65000), press_exit);
+    fb_reset(); // As done by the main menu before entering the module
+    trend_stats = (trend_stats_t){0};
+    temperatures();
+    check_trend("temperature");
+    print_history("temperature", ADC_SCAN_THERMISTOR);
+}
+
+static void run_light(){
+    scenario_start();
+    sim_adc_script(HAL_ADC_PHOTODIODE, photodiode_script, 3);
+    sim_at(SIM_MS(65000), press_exit);
+    trend_stats = (trend_stats_t){0};
+    light();
+    check_trend("light");
+    print_history("light", ADC_SCAN_PHOTODIODE);
+}
+
+static void run_leds(){
+    scenario_start();
+    sim_adc_script(HAL_ADC_POTENTIOMETER, potentiometer_script, 5);
+    sim_at(SIM_MS(2000), press_sw2);
+    sim_at(SIM_MS(5000), press_exit);
+    leds_delay_control();
+
+    scenario_start();
+    encoder_phase = 0;
+    for(uint32_t i = 1; i <= 40; i++) sim_at(SIM_MS(i * 5), encoder_step);
+    sim_at(SIM_MS(250), press_exit);
+    encoder_leds();
+}
+
+static void run_games(){
+    scenario_start();
+    hal_set_module(HAL_MOD_MENU); // Seeded at boot from main()
+    adc_scan_stop();
+    seed_generator();
+    adc_scan_start();
+    sim_at(SIM_MS(100), dip_set);
+    sim_at(SIM_MS(500), press_exit);
+    guess_number();
+
+    /* Six LEFT presses per try, three tries */
+    scenario_start();
+    release_nav();
+    for(uint32_t i = 0; i < 18; i++){
+        sim_at(SIM_MS(8000 + i * 200), nav_left_press);
+        sim_at(SIM_MS(8100 + i * 200), nav_left_release);
+    }
+    row_game();
+}
+
+/* Cost of the boot seed with each entropy backend, stuck pin included */
+static void measure_entropy(){
+    static const char *const sources[] = {"none", "trng", "adc"};
+    static const struct {
+        const char *name;
+        bool trng;
+        bool stuck;
+    } cases[] = {
+        {"adc",       0, 0},
+        {"trng",      1, 0},
+        {"stuck adc", 0, 1},
+    };
+
+    for(uint32_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++){
+        scenario_start();
+        hal_set_module(HAL_MOD_MENU);
+        adc_scan_stop();
+        sim_trng(cases[k].trng);
+        sim_adc_stuck(HAL_ADC_FLOATING, cases[k].stuck);
+        entropy_stats = (entropy_stats_t){0};
+        uint64_t seed;
+        entropy_seed(&seed);
+        printf("entropy %-10s -> %-4s %6u us, %u blocks, %u repetition / %u proportion failures\n",
+               cases[k].name, sources[entropy_stats.source], entropy_stats.ticks / (HAL_TIMER_CLOCK_HZ / 1000000U),
+               entropy_stats.adc_blocks, entropy_stats.repetition_failures, entropy_stats.proportion_failures);
+    }
+}
+
+/* Encoder sweep: a steady clockwise spin with one edge every 'sweep_spacing'
+ * cycles. The handler reads the pins SIM_GPIO_IRQ_CYCLES after the edge that
+ * raised it; edges in between only keep the interrupt pending. */
+static uint64_t sweep_spacing;
+static uint32_t sweep_left;
+static bool sweep_pending;
+
+static void sweep_irq(){
+    sweep_pending = 0;
+    encoder_edge();
+}
+
+static void sweep_edge(){
+    encoder_move(1);
+    if(!sweep_pending){
+        sweep_pending = 1;
+        sim_at(sim_cycles + SIM_GPIO_IRQ_CYCLES, sweep_irq);
+    }
+    if(--sweep_left > 0) sim_at(sim_cycles + sweep_spacing, sweep_edge);
+}
+
+/* True if 1000 edges 'spacing' cycles apart were all counted */
+static bool sweep_ok(uint64_t spacing){
+    const uint32_t edges = 1000U;
+
+    scenario_start();
+    encoder_phase = 0;
+    sim_gpio_set(HAL_PORT3, SHIELD_ROTARY_1_GPIO_PIN, 0);
+    sim_gpio_set(HAL_PORT3, SHIELD_ROTARY_2_GPIO_PIN, 0);
+    encoder_stats.errors = 0;
+    encoder_start();
+    sweep_spacing = spacing;
+    sweep_left = edges;
+    sweep_pending = 0;
+    sim_at(sim_cycles + spacing, sweep_edge);
+    sim_advance(spacing * (edges + 1U) + SIM_GPIO_IRQ_CYCLES);
+    encoder_stop();
+    return encoder_stats.errors == 0 && encoder_position() == (int32_t)edges;
+}
+
+/* Highest step rate the decoder follows without an error: halve the edge
+ * spacing until it fails, then bisect */
+static void measure_encoder(){
+    uint64_t best = SIM_MS(1);
+    uint64_t fail = best / 2U;
+    while(fail > 0 && sweep_ok(fail)){
+        best = fail;
+        fail /= 2U;
+    }
+    while(best - fail > 1U){
+        uint64_t mid = (best + fail) / 2U;
+        if(sweep_ok(mid)) best = mid;
+        else fail = mid;
+    }
+    printf("encoder: error-free up to %llu counts/s (%llu cycles per edge, %u cycle handler latency)\n",
+           (unsigned long long)(HAL_TIMER_CLOCK_HZ / best), (unsigned long long)best, SIM_GPIO_IRQ_CYCLES);
+}
+
+/* Bytes on the bus to draw a static screen from a blank display */
+static void measure_screen(const char *name, void (*draw)()){
+    scenario_start();
+    hal_set_module(HAL_MOD_MENU);
+    fb_reset();
+    oledq_wait();
+    uint32_t before = oledc_stats.bus_bytes;
+    draw();
+    oledq_wait();
+    printf("screen %-12s %6u bus bytes\n", name, oledc_stats.bus_bytes - before);
+}
+
+/* Host cost of the scan filters, measured on the real clock rather than the virtual one */
+static void bench_filters(){
+    static const struct {
+        const char *name;
+        filter_kind_t kind;
+        uint8_t shift;
+    } kinds[] = {
+        {"none",           FILTER_NONE,           0U},
+        {"iir",            FILTER_IIR,            3U},
+        {"moving average", FILTER_MOVING_AVERAGE, 0U},
+        {"median",         FILTER_MEDIAN,         0U},
+    };
+    const uint32_t samples = 1000000U;
+
+    for(uint32_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++){
+        filter_t filter;
+        filter_init(&filter, kinds[k].kind, kinds[k].shift);
+        uint32_t noise = 0x1234567U;
+        volatile uint16_t sink = 0;
+        struct timespec t0, t1;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(uint32_t i = 0; i < samples; i++){
+            noise ^= noise << 13;
+            noise ^= noise >> 17;
+            noise ^= noise << 5;
+            sink = filter_update(&filter, (uint16_t)(0x8000U + (noise & 0x1FFU)));
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        (void)sink;
+
+        double ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec);
+        printf("filter %-16s %6.2f ns/sample\n", kinds[k].name, ns / samples);
+    }
+}
+
+/* Statistical checks of the generator from a fixed seed. Each statistic is
+ * compared with its 0.1 % critical value, so a good generator fails about
+ * one check in a thousand runs. */
+static uint32_t rng_failures;
+
+static void rng_report(const char *name, double stat, double limit){
+    bool pass = stat < limit;
+    if(!pass) rng_failures++;
+    printf("rng %-20s %10.2f (limit %7.2f) %s\n", name, stat, limit, pass ? "ok" : "FAIL");
+}
+
+/* Chi-square of 'n' draws of rng_below(bins) against the uniform expectation */
+static double rng_chi_square(uint32_t bins, uint32_t n){
+    static uint32_t counts[256];
+    for(uint32_t i = 0; i < bins; i++) counts[i] = 0;
+    for(uint32_t i = 0; i < n; i++) counts[rng_below(bins)]++;
+    double expected = (double)n / bins, chi = 0;
+    for(uint32_t i = 0; i < bins; i++) chi += (counts[i] - expected) * (counts[i] - expected) / expected;
+    return chi;
+}
+
+static void check_rng(){
+    const uint32_t n = 1000000U;
+    rng_failures = 0;
+    rng_seed(1U);
+
+    /* Monobit: z^2 of the count of one bits over 32 n bits */
+    uint64_t ones = 0;
+    for(uint32_t i = 0; i < n; i++) ones += (uint32_t)__builtin_popcount(rng_next());
+    double bits = 32.0 * n, excess = 2.0 * (double)ones - bits;
+    rng_report("monobit z^2", excess * excess / bits, 10.83);
+
+    rng_report("below(10) chi^2", rng_chi_square(10U, n), 27.88);
+    rng_report("below(7) chi^2", rng_chi_square(7U, n), 22.46);
+    rng_report("below(256) chi^2", rng_chi_square(256U, n), 330.52);
+
+    /* Consecutive pairs of rng_below(16) as one of 256 cells */
+    static uint32_t pairs[256];
+    for(uint32_t i = 0; i < 256U; i++) pairs[i] = 0;
+    for(uint32_t i = 0; i < n; i++) pairs[(rng_below(16U) << 4) | rng_below(16U)]++;
+    double expected = (double)n / 256U, chi = 0;
+    for(uint32_t i = 0; i < 256U; i++) chi += (pairs[i] - expected) * (pairs[i] - expected) / expected;
+    rng_report("pairs(16) chi^2", chi, 330.52);
+
+    /* Serial correlation of successive numbers as fractions of 2^32, n r^2 is chi^2 with 1 dof */
+    double sx = 0, sxx = 0, sxy = 0, first = rng_next() / 4294967296.0, prev = first;
+    for(uint32_t i = 1; i < n; i++){
+        double x = rng_next() / 4294967296.0;
+        sx += prev;
+        sxx += prev * prev;
+        sxy += prev * x;
+        prev = x;
+    }
+    sx += prev;
+    sxx += prev * prev;
+    sxy += prev * first; // Wrap around so both sums cover the same n numbers
+    double r = (n * sxy - sx * sx) / (n * sxx - sx * sx);
+    rng_report("serial n*r^2", n * r * r, 10.83);
+
+    /* Bias: with bound 3 * 2^30 a third of the values lie below 2^30. A plain
+     * modulo folds the top quarter of the 32-bit range onto them. */
+    const uint32_t bound = 3U << 30;
+    uint32_t lemire = 0, modulo = 0;
+    for(uint32_t i = 0; i < n; i++){
+        if(rng_below(bound) < (1U << 30)) lemire++;
+        if(rng_next() % bound < (1U << 30)) modulo++;
+    }
+    double third = n / 3.0;
+    rng_report("below(3<<30) chi^2", (lemire - third) * (lemire - third) / third
+                                     + (lemire - third) * (lemire - third) / (2.0 * third), 10.83);
+    printf("rng below 2^30 of 3<<30: %.4f with rng_below, %.4f with %%\n", (double)lemire / n, (double)modulo / n);
+
+    /* The whole byte range is reachable, 255 included */
+    uint32_t top = 0;
+    for(uint32_t i = 0; i < 4096U; i++) top += rng_below(256U) == 255U;
+    rng_report("below(256) no 255", top == 0, 1);
+
+    printf("rng: %u of 8 checks failed\n", rng_failures);
+}
+
+/* Host throughput of the generator, single calls and a batch */
+static void bench_rng(){
+    static uint32_t batch[256];
+    const uint32_t numbers = 10000000U;
+    volatile uint32_t sink = 0;
+    struct timespec t0, t1;
+    double ns[3];
+
+    for(uint32_t k = 0; k < 3; k++){
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if(k == 0){
+            for(uint32_t i = 0; i < numbers; i++) sink = rng_next();
+        } else if(k == 1){
+            for(uint32_t i = 0; i < numbers; i++) sink = rng_below(6U);
+        } else {
+            for(uint32_t i = 0; i < numbers; i += 256U){
+                rng_fill(batch, 256U);
+                sink = batch[255];
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        ns[k] = (double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec);
+    }
+    (void)sink;
+
+    static const char *const names[3] = {"rng_next", "rng_below(6)", "rng_fill x256"};
+    for(uint32_t k = 0; k < 3; k++){
+        printf("rng %-16s %6.2f ns/number %8.1f M numbers/s\n", names[k], ns[k] / numbers, numbers / ns[k] * 1e3);
+    }
+}
+
+/* The trace table of the whole run, in host ns; empty unless built with TRACE_ENABLE=1 */
+static void print_trace(){
+    printf("%-16s %8s %9s %9s %9s  log2 histogram from bucket\n", "trace", "count", "min ns", "mean ns", "max ns");
+    for(uint32_t s = 0; s < TRACE_SCOPES; s++){
+        trace_entry_t entry;
+        if(!trace_snapshot((trace_scope_t)s, &entry) || entry.count == 0) continue;
+        uint32_t first = 0, last = TRACE_BUCKETS - 1U;
+        while(entry.histogram[first] == 0) first++;
+        while(entry.histogram[last] == 0) last--;
+        printf("%-16s %8u %9u %9u %9u  %2u:", trace_names[s], entry.count, entry.min,
+               (uint32_t)(entry.sum / entry.count), entry.max, first);
+        for(uint32_t b = first; b <= last; b++) printf(" %u", entry.histogram[b]);
+        printf("\n");
+    }
+}
+
+/* Optional argument: file that receives the telemetry stream, for tools/telemetry_decode.py */
+int main(int argc, char **argv){
+    FILE *capture = (argc > 1) ? fopen(argv[1], "wb") : NULL;
+    sim_uart_capture(capture);
+    hal_reset_stats();
+    run_temperature();
+    run_light();
+    run_leds();
+    run_games();
+    measure_screen("main menu", OLED_main_meniu);
+    measure_screen("leds menu", oled_leds_meniu);
+
+    oledq_wait();
+    sim_print_stats(stdout);
+    printf("oled queue: %u enqueued, %u dropped, %u frames dropped, max depth %u\n",
+           oledq_stats.enqueued, oledq_stats.dropped, oledq_stats.frames_dropped, oledq_stats.max_depth);
+    adc_sample_t last = adc_scan_latest(ADC_SCAN_THERMISTOR);
+    printf("adc scan: %u triggers, %u intervals, %u missed\n",
+           last.sequence, adc_scan_intervals(), adc_scan_missed());
+    printf("input: %u posted, %u handled, %u overflows, %u discarded, latency (<16us..>=64ms):",
+           input_stats.posted, input_stats.handled, input_stats.overflows, input_stats.discarded);
+    for(uint32_t i = 0; i < INPUT_LATENCY_BINS; i++) printf(" %u", input_stats.latency[i]);
+    printf("\n");
+    print_trace();
+    sim_uart_input("d"); // Console dump of the trace table into the stream, one scope per flush
+    sim_advance(SIM_MS(TELEMETRY_FLUSH_MS * (TRACE_SCOPES + 1U)));
+    telemetry_stop();
+    printf("telemetry: %u records, %u dropped, %u frames, %u bytes on the wire (%.1f per record)\n",
+           telemetry_stats.records, telemetry_stats.dropped, telemetry_stats.frames, telemetry_stats.bytes,
+           telemetry_stats.records ? (double)telemetry_stats.bytes / telemetry_stats.records : 0.0);
+    sim_uart_capture(NULL);
+    if(capture) fclose(capture);
+    bench_filters();
+    check_rng();
+    bench_rng();
+    measure_entropy();
+    measure_encoder(); // Last: resets the simulated hardware between sweeps
+    return 0;
+}
+
+#endif /* HOST_SIM && !SIM_BENCH */
@@ -0,0 +1,105 @@
+#include "hal.h"
+#include "sched.h"
+#include "swtimer.h"
+
+#define SWTIMER_SLOT_MASK (SWTIMER_SLOTS - 1U)
+
+static swtimer_t *wheel[SWTIMER_LEVELS][SWTIMER_SLOTS];
+static volatile uint32_t now = 0;
+
+/* Slot of the lowest level whose span covers the remaining time */
+static void swtimer_place(swtimer_t *timer){
+    uint32_t delta = timer->expires - now;
+    uint32_t level = 0;
+    while(level < SWTIMER_LEVELS - 1U && delta >= (1U << (SWTIMER_SLOT_BITS * (level + 1U)))) level++;
+
+    uint32_t slot;
+    if(delta >= (1U << (SWTIMER_SLOT_BITS * SWTIMER_LEVELS))){
+        /* Beyond the wheel: park in the last top level slot and re-place on its cascade */
+        slot = ((now >> (SWTIMER_SLOT_BITS * level)) + SWTIMER_SLOT_MASK) & SWTIMER_SLOT_MASK;
+    } else {
+        slot = (timer->expires >> (SWTIMER_SLOT_BITS * level)) & SWTIMER_SLOT_MASK;
+    }
+
+    swtimer_t **head = &wheel[level][slot];
+    timer->next = *head;
+    if(*head) (*head)->prev = &timer->next;
+    timer->prev = head;
+    *head = timer;
+}
+
+static void swtimer_unlink(swtimer_t *timer){
+    *timer->prev = timer->next;
+    if(timer->next) timer->next->prev = timer->prev;
+    timer->prev = NULL;
+}
+
+/* Moves every timer of a higher level slot down to where it now belongs */
+static void swtimer_cascade(uint32_t level){
+    uint32_t slot = (now >> (SWTIMER_SLOT_BITS * level)) & SWTIMER_SLOT_MASK;
+    swtimer_t *timer = wheel[level][slot];
+    wheel[level][slot] = NULL;
+    while(timer){
+        swtimer_t *next = timer->next;
+        swtimer_place(timer);
+        timer = next;
+    }
+}
+
+void swtimer_init(){
+    hal_timer_set_period(HAL_TIMER_CLOCK_HZ / SWTIMER_TICK_HZ);
+    hal_timer_start();
+}
+
+void swtimer_tick(){
+    now++;
+
+    /* Top level first, so its timers can land in the level 1 slot cascaded next */
+    for(uint32_t level = SWTIMER_LEVELS - 1U; level > 0; level--){
+        if((now & ((1U << (SWTIMER_SLOT_BITS * level)) - 1U)) == 0) swtimer_cascade(level);
+    }
+
+    swtimer_t **head = &wheel[0][now & SWTIMER_SLOT_MASK];
+    while(*head){
+        swtimer_t *timer = *head;
+        swtimer_unlink(timer);
+        timer->expired = 1;
+        if(timer->period){
+            timer->expires += timer->period;
+            swtimer_place(timer);
+        }
+        if(timer->callback) timer->callback(timer);
+    }
+}
+
+uint32_t swtimer_now(){
+    return now;
+}
+
+void swtimer_start(swtimer_t *timer, uint32_t ms, uint32_t period_ms, swtimer_callback_t callback){
+    hal_irq_disable();
+    if(swtimer_active(timer)) swtimer_unlink(timer);
+    timer->expires = now + ((ms > 0) ? ms : 1U);
+    timer->period = period_ms;
+    timer->expired = 0;
+    timer->callback = callback;
+    swtimer_place(timer);
+    hal_irq_enable();
+}
+
+void swtimer_cancel(swtimer_t *timer){
+    hal_irq_disable();
+    if(swtimer_active(timer)) swtimer_unlink(timer);
+    timer->expired = 0;
+    hal_irq_enable();
+}
+
+bool swtimer_active(const swtimer_t *timer){
+    return timer->prev != NULL;
+}
+
+void swtimer_delay(uint32_t ms){
+    swtimer_t timer = {0};
+    swtimer_start(&timer, ms, 0, NULL);
+    sched_wait(&timer.expired);
+}
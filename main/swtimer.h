@@ -0,0 +1,55 @@
+#ifndef SWTIMER_H_
+#define SWTIMER_H_
+
+#include "hal.h"
+
+/*
+ * SOFTWARE TIMERS
+ * CTIMER0 runs a fixed 1 ms tick and is never reconfigured by the modules;
+ * any number of one-shot or periodic virtual timers hang off it in a
+ * hierarchical timer wheel (3 levels of 64 slots: 64 ms, 4 s, 262 s).
+ * Timers sit in doubly linked slot lists, so start and cancel are O(1);
+ * a tick only touches the current slot, plus one cascade every 64 ms.
+ * Longer timeouts park in the top level and are re-placed as they come
+ * closer. Expiry sets 'expired' and calls the optional callback, both from
+ * the timer interrupt.
+ */
+
+#define SWTIMER_TICK_HZ   1000U
+#define SWTIMER_LEVELS    3U
+#define SWTIMER_SLOT_BITS 6U
+#define SWTIMER_SLOTS     (1U << SWTIMER_SLOT_BITS)
+
+typedef struct swtimer swtimer_t;
+
+typedef void (*swtimer_callback_t)(swtimer_t *timer);
+
+struct swtimer {
+    swtimer_t *next;
+    swtimer_t **prev;             // Link pointing at this timer, NULL when not armed
+    uint32_t expires;             // Tick of the next expiry
+    uint32_t period;              // Ticks between expiries, 0 = one-shot
+    volatile uint32_t expired;    // Set on each expiry, cleared by the owner
+    swtimer_callback_t callback;  // Optional, runs in interrupt context
+};
+
+/* Starts the CTIMER0 tick, called once before any timer is used */
+void swtimer_init();
+
+/* Tick handler, called from the CTIMER0 match interrupt */
+void swtimer_tick();
+
+/* Ticks (ms) since swtimer_init() */
+uint32_t swtimer_now();
+
+/* (Re)arms 'timer' to expire in 'ms' (at least one tick), then every 'period_ms' if not 0 */
+void swtimer_start(swtimer_t *timer, uint32_t ms, uint32_t period_ms, swtimer_callback_t callback);
+
+void swtimer_cancel(swtimer_t *timer);
+
+bool swtimer_active(const swtimer_t *timer);
+
+/* Sleeps (WFI) for 'ms' */
+void swtimer_delay(uint32_t ms);
+
+#endif /* SWTIMER_H_ */
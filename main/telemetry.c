@@ -0,0 +1,282 @@
+#include "hal.h"
+#include "swtimer.h"
+#include "adc_scan.h"
+#include "input.h"
+#include "oled_queue.h"
+#include "trace.h"
+#include "telemetry.h"
+
+/* Worst case of COBS: one code byte per 254 data bytes, plus the delimiter */
+#define TELEMETRY_WIRE_MAX (TELEMETRY_FRAME_MAX + TELEMETRY_FRAME_MAX / 254U + 2U)
+
+/* Largest records: tag, dt and the fields, 3 bytes for a zigzag 16-bit delta and 5 for any other varint */
+#define TELEMETRY_SCAN_MAX     (6U + 3U * ADC_SCAN_CHANNELS)
+#define TELEMETRY_INPUT_MAX    8U
+#define TELEMETRY_COUNTERS_MAX (6U + 5U * TELEMETRY_COUNTER_COUNT)
+#define TELEMETRY_TRACE_MAX    (6U + 5U * 7U + 5U * TRACE_BUCKETS)
+
+_Static_assert(TELEMETRY_TRACE_MAX + 8U <= TELEMETRY_FRAME_MAX, "trace record does not fit a frame");
+
+typedef struct {
+    uint8_t data[TELEMETRY_FRAME_MAX];
+    uint32_t len;
+    uint32_t records;
+    uint32_t last_ms;                      // Time of the previous record
+    uint16_t last_scan[ADC_SCAN_CHANNELS];
+} telemetry_frame_t;
+
+telemetry_stats_t telemetry_stats;
+
+static telemetry_frame_t frames[2];
+static telemetry_frame_t *building = &frames[0];
+static telemetry_frame_t *volatile sealed = NULL;  // Waiting for, or being sent by, the UART
+static volatile bool sending = 0;
+static bool started = 0;  // Building frame is open, between telemetry_start() and telemetry_stop()
+static uint8_t wire[TELEMETRY_WIRE_MAX];
+static uint8_t sequence = 0;
+static uint32_t flushes = 0;
+static uint32_t trace_dump = TRACE_SCOPES;  // Next scope to dump, TRACE_SCOPES when none
+static swtimer_t flush_timer;
+
+/* CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), a nibble at a time */
+static const uint16_t crc_nibble[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+static uint16_t telemetry_crc(const uint8_t *data, uint32_t len){
+    uint16_t crc = 0xFFFFU;
+    for(uint32_t i = 0; i < len; i++){
+        crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (data[i] & 0x0FU)]);
+    }
+    return crc;
+}
+
+static uint32_t telemetry_varint(uint8_t *out, uint32_t value){
+    uint32_t n = 0;
+    while(value >= 0x80U){
+        out[n++] = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint32_t telemetry_zigzag(int32_t value){
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+/* Zeros become the distance to the next zero, the frame ends with a 0x00 */
+static uint32_t telemetry_cobs(const uint8_t *in, uint32_t len, uint8_t *out){
+    uint32_t code_at = 0, n = 1;
+    uint8_t code = 1;
+    for(uint32_t i = 0; i < len; i++){
+        if(in[i] != 0){
+            out[n++] = in[i];
+            code++;
+        }
+        if(in[i] == 0 || code == 0xFFU){
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+        }
+    }
+    out[code_at] = code;
+    out[n++] = 0x00U;
+    return n;
+}
+
+/* Sequence number (set when sealed) and base time open every frame */
+static void telemetry_open(telemetry_frame_t *frame, uint32_t now){
+    frame->data[0] = 0;
+    frame->len = 1U + telemetry_varint(&frame->data[1], now);
+    frame->records = 0;
+    frame->last_ms = now;
+    for(uint32_t i = 0; i < ADC_SCAN_CHANNELS; i++) frame->last_scan[i] = 0;
+}
+
+/* Hands the building frame to the sender, 0 if the previous one is still out.
+ * Called with interrupts disabled. */
+static bool telemetry_seal(uint32_t now){
+    if(sealed || building->records == 0) return 0;
+    building->data[0] = sequence++;
+    sealed = building;
+    building = (building == &frames[0]) ? &frames[1] : &frames[0];
+    telemetry_open(building, now);
+    return 1;
+}
+
+static void telemetry_sent(){
+    sealed = NULL;
+    sending = 0;
+}
+
+/* Starts the UART on the sealed frame unless it is busy. The CRC and COBS
+ * pass run with interrupts enabled: until the write completes, the sealed
+ * frame and the wire buffer belong to the sender alone. */
+static void telemetry_kick(){
+    hal_irq_disable();
+    telemetry_frame_t *frame = sealed;
+    bool start = frame && !sending;
+    if(start) sending = 1;
+    hal_irq_enable();
+    if(!start) return;
+
+    TRACE_BEGIN(TRACE_TELEMETRY_KICK);
+    uint16_t crc = telemetry_crc(frame->data, frame->len);
+    frame->data[frame->len] = (uint8_t)crc;
+    frame->data[frame->len + 1U] = (uint8_t)(crc >> 8);
+    uint32_t n = telemetry_cobs(frame->data, frame->len + 2U, wire);
+    telemetry_stats.frames++;
+    telemetry_stats.bytes += n;
+    TRACE_END(TRACE_TELEMETRY_KICK);
+    hal_uart_write_async(wire, n, telemetry_sent);
+}
+
+/* Building frame with room for a record of up to 'max' bytes,
+ * sealing the full one first, with the tag and time of the record written;
+ * NULL (and a dropped record) when both frames are taken or the stream is
+ * not started. Called with interrupts disabled, the caller appends the fields. */
+static telemetry_frame_t *telemetry_begin(telemetry_record_t tag, uint32_t max, uint32_t now, bool *kick){
+    if(!started){
+        telemetry_stats.dropped++;
+        return NULL;
+    }
+    if(building->len + max + 2U > TELEMETRY_FRAME_MAX){
+        if(!telemetry_seal(now)){
+            telemetry_stats.dropped++;
+            return NULL;
+        }
+        *kick = 1;
+    }
+    telemetry_frame_t *frame = building;
+    frame->data[frame->len++] = (uint8_t)tag;
+    frame->len += telemetry_varint(&frame->data[frame->len], now - frame->last_ms);
+    frame->last_ms = now;
+    frame->records++;
+    telemetry_stats.records++;
+    return frame;
+}
+
+void telemetry_scan(const uint16_t *values){
+    uint32_t now = swtimer_now();
+    bool kick = 0;
+
+    hal_irq_disable();
+    telemetry_frame_t *frame = telemetry_begin(TELEMETRY_SCAN, TELEMETRY_SCAN_MAX, now, &kick);
+    if(frame){
+        for(uint32_t i = 0; i < ADC_SCAN_CHANNELS; i++){
+            frame->len += telemetry_varint(&frame->data[frame->len],
+                                           telemetry_zigzag((int32_t)values[i] - frame->last_scan[i]));
+            frame->last_scan[i] = values[i];
+        }
+    }
+    hal_irq_enable();
+    if(kick) telemetry_kick();
+}
+
+void telemetry_input(uint8_t button, uint8_t edge){
+    uint32_t now = swtimer_now();
+    bool kick = 0;
+
+    hal_irq_disable();
+    telemetry_frame_t *frame = telemetry_begin(TELEMETRY_INPUT, TELEMETRY_INPUT_MAX, now, &kick);
+    if(frame) frame->len += telemetry_varint(&frame->data[frame->len], ((uint32_t)button << 1) | (edge & 1U));
+    hal_irq_enable();
+    if(kick) telemetry_kick();
+}
+
+static void telemetry_counters(uint32_t now){
+    uint32_t counters[TELEMETRY_COUNTER_COUNT];
+    uint32_t n = 0;
+    for(uint32_t m = 0; m < HAL_MOD_COUNT; m++) counters[n++] = hal_idle_permille((hal_module_t)m);
+    counters[n++] = adc_scan_missed();
+    counters[n++] = input_stats.overflows;
+    counters[n++] = input_stats.bounces;
+    counters[n++] = oledq_stats.frames_dropped;
+    counters[n++] = telemetry_stats.dropped;
+    bool kick = 0;
+
+    hal_irq_disable();
+    telemetry_frame_t *frame = telemetry_begin(TELEMETRY_COUNTERS, TELEMETRY_COUNTERS_MAX, now, &kick);
+    for(uint32_t i = 0; frame && i < n; i++) frame->len += telemetry_varint(&frame->data[frame->len], counters[i]);
+    hal_irq_enable();
+    if(kick) telemetry_kick();
+}
+
+/* Next scope of a dump that recorded anything, its histogram trimmed to the
+ * used buckets; a scope caught mid-record is retried on the next flush */
+static void telemetry_trace(uint32_t now){
+    trace_entry_t entry;
+    do {
+        if(!trace_snapshot((trace_scope_t)trace_dump, &entry)) return;
+    } while(entry.count == 0 && ++trace_dump < TRACE_SCOPES);
+    if(trace_dump >= TRACE_SCOPES) return;
+
+    uint32_t first = 0, last = TRACE_BUCKETS - 1U;
+    while(entry.histogram[first] == 0) first++;
+    while(entry.histogram[last] == 0) last--;
+    uint32_t fields[7] = {trace_dump, TRACE_CLOCK_HZ / 1000U, entry.count, entry.min, entry.max,
+                          (uint32_t)(entry.sum / entry.count), first};
+    bool kick = 0;
+
+    hal_irq_disable();
+    telemetry_frame_t *frame = telemetry_begin(TELEMETRY_TRACE, TELEMETRY_TRACE_MAX, now, &kick);
+    if(frame){
+        for(uint32_t i = 0; i < 7U; i++) frame->len += telemetry_varint(&frame->data[frame->len], fields[i]);
+        frame->len += telemetry_varint(&frame->data[frame->len], last - first + 1U);
+        for(uint32_t b = first; b <= last; b++){
+            frame->len += telemetry_varint(&frame->data[frame->len], entry.histogram[b]);
+        }
+        trace_dump++;
+    }
+    hal_irq_enable();
+    if(kick) telemetry_kick();
+}
+
+static void telemetry_command(uint8_t command){
+    if(command == TELEMETRY_CMD_TRACE_DUMP) trace_dump = 0;
+    if(command == TELEMETRY_CMD_TRACE_RESET) trace_reset();
+}
+
+/* Flush timer: console commands, the counters once in a while and the next
+ * scope of a trace dump, then whatever the frame holds goes out */
+static void telemetry_flush(swtimer_t *timer){
+    uint32_t now = swtimer_now();
+    uint8_t command;
+    while(hal_uart_read(&command)) telemetry_command(command);
+    if(++flushes % (TELEMETRY_COUNTERS_MS / TELEMETRY_FLUSH_MS) == 0) telemetry_counters(now);
+    if(trace_dump < TRACE_SCOPES) telemetry_trace(now);
+
+    hal_irq_disable();
+    telemetry_seal(now);
+    hal_irq_enable();
+    telemetry_kick();
+}
+
+void telemetry_start(){
+    hal_irq_disable();
+    telemetry_open(building, swtimer_now());
+    started = 1;
+    hal_irq_enable();
+    flushes = 0;
+    trace_dump = TRACE_SCOPES;
+    swtimer_start(&flush_timer, TELEMETRY_FLUSH_MS, TELEMETRY_FLUSH_MS, telemetry_flush);
+}
+
+void telemetry_stop(){
+    swtimer_cancel(&flush_timer);
+    hal_irq_disable();
+    started = 0;
+    hal_irq_enable();
+    for(;;){
+        hal_irq_disable();
+        telemetry_seal(swtimer_now());
+        bool idle = !sealed && building->records == 0;
+        hal_irq_enable();
+        if(idle) break;
+        telemetry_kick();
+        hal_idle();
+    }
+}
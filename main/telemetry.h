@@ -0,0 +1,74 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include "hal.h"
+
+/*
+ * TELEMETRY
+ * Binary stream of ADC scans, input events and counters on the debug UART,
+ * sent by EDMA in the background. Records are appended to a frame from any
+ * context; a full frame, or every TELEMETRY_FLUSH_MS, is sealed and sent
+ * while the next one fills. Frame before COBS framing:
+ *
+ *   seq (1 byte) | base ms (varint) | records... | CRC-16/CCITT-FALSE (LE)
+ *
+ * Each record is a tag, the ms since the previous record (or the base) and
+ * its fields, all as LEB128 varints:
+ *   TELEMETRY_SCAN      zigzag delta of every filtered ADC_SCAN channel
+ *                       from its previous value in the frame (0 at the start)
+ *   TELEMETRY_INPUT     button << 1 | edge
+ *   TELEMETRY_COUNTERS  idle share of each hal_module_t in 0.1 %, then the
+ *                       totals of ADC missed scans, input overflows and
+ *                       bounces, OLED frames dropped and telemetry records
+ *                       dropped
+ *   TELEMETRY_TRACE     trace_scope_t, trace clock in kHz, count, min, max,
+ *                       mean, first histogram bucket, number of buckets
+ *                       sent and their counts (see trace.h)
+ * Every frame decodes on its own, so a lost frame only loses its records.
+ * COBS removes the zero bytes and a 0x00 ends each frame on the wire.
+ * tools/telemetry_decode.py turns a capture into CSV.
+ *
+ * The same UART takes one-byte console commands, polled by the flush timer:
+ *   'd'  dumps the trace table, one TELEMETRY_TRACE record per used scope
+ *        and flush
+ *   'r'  clears the trace table
+ */
+
+#define TELEMETRY_FRAME_MAX   240U  // Frame bytes before COBS, CRC included
+#define TELEMETRY_FLUSH_MS    100U
+#define TELEMETRY_COUNTERS_MS 1000U
+#define TELEMETRY_COUNTER_COUNT (HAL_MOD_COUNT + 5U)
+
+#define TELEMETRY_CMD_TRACE_DUMP  'd'
+#define TELEMETRY_CMD_TRACE_RESET 'r'
+
+typedef enum {
+    TELEMETRY_SCAN = 1,
+    TELEMETRY_INPUT,
+    TELEMETRY_COUNTERS,
+    TELEMETRY_TRACE
+} telemetry_record_t;
+
+typedef struct {
+    uint32_t records;
+    uint32_t dropped;  // Records lost with both frame buffers taken or the stream stopped
+    uint32_t frames;
+    uint32_t bytes;    // On the wire, COBS and delimiters included
+} telemetry_stats_t;
+
+extern telemetry_stats_t telemetry_stats;
+
+/* Opens the first frame and starts the flush timer, called after
+ * swtimer_init(). Records before it are dropped. */
+void telemetry_start();
+
+/* Sends whatever is buffered and waits for the UART to finish, records
+ * from then on are dropped until the next telemetry_start() */
+void telemetry_stop();
+
+/* One filtered scan, values in adc_scan_channel_t order, from the ADC interrupt */
+void telemetry_scan(const uint16_t *values);
+
+void telemetry_input(uint8_t button, uint8_t edge);
+
+#endif /* TELEMETRY_H_ */
@@ -1,120 +1,91 @@
-#include "board.h"
-#include "app.h"
-#include <stdio.h>
-#include "peripherals.h"
-#include "pin_mux.h"
-#include "clock_config.h"
-#include "MCXN947_cm33_core0.h"
-#include "fsl_debug_console.h"
-#include "fsl_lpi2c.h"
-#include "fsl_device_registers.h"
+#include "hal.h"
 #include "oled.h"
-#include "math.h"
+#include "oled_fb.h"
+#include "oled_queue.h"
+#include "input.h"
+#include "adc_scan.h"
+#include "thermistor.h"
 #include "leds.h"
+#include "trend.h"
+#include "numfield.h"
 #include "temperature.h"
 
-uint8_t adc_flag = 0; // Trigger flag for ADC conversion after a full LED cycle
+uint8_t adc_flag = 0; // Set when the scan latched a new 30 s sample
+
+#define TEMP_SEG   33U  // First column after the "Temp:" frame
+#define TEMP_CELLS 5U   // "-40.00" / "125.00", two of them after the point
+
+/* Trend graph units: 0.01 degC */
+static int32_t temperature_units(uint16_t raw){
+    return thermistor_centi_celsius(raw);
+}
 
 void temperatures(){
-    /* 1. TIMER SETUP
-     * Configure CTIMER0 for the LED ring update frequency.
-     * The match value determines the interval between lighting up consecutive LEDs.
+    /* 1. LED RING SETUP
+     * Countdown animation: one LED fades in per step, the whole ring per
+     * 30 s sample interval. It plays from the timer and DMA on its own.
      */
-    matchConfig = CTIMER0_Match_0_config;
-    matchConfig.matchValue = 562500000U;
-    CTIMER_SetupMatch(CTIMER0_PERIPHERAL, CTIMER0_MATCH_0_CHANNEL, &matchConfig);
-    CTIMER_StartTimer(CTIMER0_PERIPHERAL);
+    hal_set_module(HAL_MOD_TEMPERATURE);
+    led_ring_dim_start();
 
     /* 2. SENSOR INITIALIZATION
-     * Set ADC0 Command Low to channel 0x03 (connected to the thermistor).
+     * Latest thermistor sample (channel 0x03) from the background scan,
+     * linearized to 0.01 degC through the generated table.
      */
-    ADC0->CMD->CMDL = 0x03; 
-    LPADC_DoSoftwareTrigger(ADC0, 1); // Start first conversion
-    LPADC_GetConvResultBlocking(ADC0, &result, 0); // Blocking read for initial data
+    int16_t temperature = thermistor_centi_celsius(adc_scan_value(ADC_SCAN_THERMISTOR));
 
-    /* Right-shift 16-bit raw value to 13-bit for display scaling */
-    uint16_t thermistor_value = result.convValue >> 3;
+    /* Display "Temp:" frame or icon, the value starts at column 33 */
+    fb_draw(0, 0, (const uint8_t*)frame5, 32);
 
-    /* Display "Temp:" frame or icon and set cursor position */
-    sendOLED((uint8_t*)frame5, 32, OLED_DATA);
-    setSeg(33);
-
-    uint8_t current_led = 0; // Index for the 8-LED progress circle
+    led_anim_play(&leds_countdown);
+    uint32_t interval = adc_scan_intervals();
 
     /* 3. VALUE RENDERING
-     * Converts the numerical ADC value to decimal digits for OLED font display.
+     * Degrees with two decimals, e.g. 23.47, right-aligned after the frame
      */
-    uint16_t div = 1;
-    while(thermistor_value / div >= 10) {
-        div *= 10;
-    }
+    numfield_t field;
+    numfield_init(&field, 0, TEMP_SEG, TEMP_CELLS, 2);
+    numfield_set(&field, temperature);
+    fb_flush();
 
-    while(div > 0) {
-        uint8_t digit = (thermistor_value / div) % 10;
-        const char *tmp = &font[digit][0];
-        sendOLED((uint8_t*)tmp, 6, OLED_DATA);
-        div /= 10;
-    }   
+    /* Last minute of 1 s points under the value, scrolled in as they arrive */
+    trend_t trend;
+    trend_start(&trend, ADC_SCAN_THERMISTOR, temperature_units);
 
-    /* Update first LED if the timer has already ticked */
-    if(timer_flag){
-        GPIO_PinWrite(LEDs[current_led].gpio, LEDs[current_led].pin, 1);
-        current_led = (current_led == 7) ? 0 : current_led + 1; 
-        timer_flag = 0;
-    }
-    
     /* 4. MAIN MONITORING LOOP
-     * Runs until 'exit_flag' is triggered via the Back button interrupt.
+     * Runs until the Back button is pressed.
+     * A refresh the queue cannot take stays dirty and goes out with the
+     * next one, so a busy bus never holds up the Back button.
      */
-    while(!exit_flag){
-                
-        /* Triggered once every 8 timer ticks (full LED circle) */
+    oledq_set_policy(OLEDQ_POLICY_DROP);
+    while(!input_take(INPUT_BACK)){
+
+        /* The scan latches a sample every 30 s on the CTIMER1 trigger grid */
+        if(adc_scan_intervals() != interval){
+            interval = adc_scan_intervals();
+            adc_flag = 1;
+        }
+
         if(adc_flag){
-            resets_led(); // Clear LEDs for the next cycle
-            setSeg(33);
-            
-            /* Clear old value on OLED by sending blank (0x00) pixels */
-            uint8_t delet[18] = {0x00};
-            sendOLED((uint8_t*)delet, 18, OLED_DATA);
+            /* Restart the countdown so the ring fills in step with the sample period */
+            led_anim_play(&leds_countdown);
 
-            /* Perform a fresh ADC read from the thermistor */
-            LPADC_DoSoftwareTrigger(ADC0, 1);
-            LPADC_GetConvResultBlocking(ADC0, &result, 0);
-            thermistor_value = result.convValue >> 3;
+            /* Take the sample of this interval */
+            temperature = thermistor_centi_celsius(adc_scan_interval(ADC_SCAN_THERMISTOR).value);
 
-            /* Render the new temperature value */
-            setSeg(33);
-            div = 1;
-            while(thermistor_value / div >= 10) div *= 10;
-            while(div > 0) {
-                uint8_t digit = (thermistor_value / div) % 10;
-                const char *tmp = &font[digit][0];
-                sendOLED((uint8_t*)tmp, 6, OLED_DATA);
-                div /= 10;
-            }   
+            /* Render the new temperature value, only changed digits are redrawn */
+            numfield_set(&field, temperature);
+            fb_flush();
             adc_flag = 0; // Reset trigger
         }
-
-        /* 5. VISUAL FEEDBACK (LED RING)
-         * Lights up one LED at a time. When the ring is full (LED 7), 
-         * it triggers a new ADC reading cycle.
-         */
-        if(timer_flag){
-            GPIO_PinWrite(LEDs[current_led].gpio, LEDs[current_led].pin, 1);
-            
-            // If we reached the end of the circle, set adc_flag to refresh data
-            adc_flag = (current_led == 7) ? 1 : 0;
-            current_led = (current_led == 7) ? 0 : current_led + 1; 
-            
-            timer_flag = 0; // Clear hardware timer flag
-        }
+        trend_update(&trend);
+        hal_idle();
     }
 
-    /* 6. EXIT PROCEDURE
+    /* 5. EXIT PROCEDURE
      * Cleanup hardware states before returning to the main menu.
      */
-    exit_flag = 0;
-    CTIMER_Reset(CTIMER0);
-    CTIMER_StopTimer(CTIMER0);
-    resets_led(); // Ensure all LEDs are OFF
+    oledq_set_policy(OLEDQ_POLICY_BLOCK);
+    led_anim_stop();
+    led_ring_dim_stop(); // Ensure all LEDs are OFF
 }
@@ -0,0 +1,14 @@
+#include "hal.h"
+#include "thermistor.h"
+#include "thermistor_lut.h"
+
+#define THERMISTOR_LUT_STEP (1 << THERMISTOR_LUT_SHIFT)
+
+int16_t thermistor_centi_celsius(uint16_t raw){
+    uint32_t i = raw >> THERMISTOR_LUT_SHIFT;
+    int32_t frac = raw & (THERMISTOR_LUT_STEP - 1);
+    int32_t low = thermistor_lut[i];
+    int32_t high = thermistor_lut[i + 1U];
+    /* Power of two divisor: a shift, rounded toward zero like the generator */
+    return (int16_t)(low + (high - low) * frac / THERMISTOR_LUT_STEP);
+}
@@ -0,0 +1,20 @@
+#ifndef THERMISTOR_H_
+#define THERMISTOR_H_
+
+#include "hal.h"
+
+/*
+ * THERMISTOR LINEARIZATION
+ * Converts a raw 16-bit thermistor result to temperature with the table in
+ * thermistor_lut.h (generated by tools/thermistor_lut.py from the NTC
+ * parameters) and linear interpolation between entries. Integer only: one
+ * table lookup, a multiply and a shift per sample, no float or math.h.
+ */
+
+#define THERMISTOR_MIN_CENTI (-4000) // Table range, results are clamped to it
+#define THERMISTOR_MAX_CENTI 12500
+
+/* Temperature in 0.01 degC */
+int16_t thermistor_centi_celsius(uint16_t raw);
+
+#endif /* THERMISTOR_H_ */
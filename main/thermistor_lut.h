@@ -0,0 +1,143 @@
+/* Generated by tools/thermistor_lut.py, do not edit */
+#ifndef THERMISTOR_LUT_H_
+#define THERMISTOR_LUT_H_
+
+/* Beta R25=10000 ohm B=3950 K, series 10000 ohm, -40..125 degC
+ * Interpolation error <= 0.016 degC inside the range */
+
+#define THERMISTOR_LUT_SHIFT   6U
+#define THERMISTOR_LUT_ENTRIES 1025U
+
+static const int16_t thermistor_lut[THERMISTOR_LUT_ENTRIES] = {
+         12500,  12500,  12500,  12500,  12500,  12500,  12500,  12500,
+         12500,  12500,  12500,  12500,  12500,  12500,  12500,  12500,
+         12500,  12500,  12500,  12500,  12500,  12500,  12500,  12500,
+         12500,  12500,  12500,  12500,  12500,  12500,  12500,  12500,
+         12500,  12500,  12500,  12500,  12439,  12325,  12215,  12109,
+         12006,  11905,  11808,  11713,  11620,  11530,  11443,  11357,
+         11274,  11192,  11113,  11035,  10959,  10885,  10812,  10741,
+         10671,  10603,  10536,  10470,  10406,  10343,  10281,  10220,
+         10160,  10101,  10044,   9987,   9931,   9876,   9822,   9769,
+          9717,   9665,   9615,   9565,   9516,   9467,   9420,   9372,
+          9326,   9280,   9235,   9191,   9147,   9103,   9060,   9018,
+          8977,   8935,   8895,   8854,   8815,   8776,   8737,   8698,
+          8661,   8623,   8586,   8549,   8513,   8477,   8442,   8407,
+          8372,   8338,   8304,   8270,   8237,   8204,   8171,   8139,
+          8107,   8075,   8044,   8013,   7982,   7952,   7921,   7891,
+          7862,   7832,   7803,   7774,   7745,   7717,   7689,   7661,
+          7633,   7606,   7578,   7551,   7525,   7498,   7471,   7445,
+          7419,   7393,   7368,   7342,   7317,   7292,   7267,   7243,
+          7218,   7194,   7170,   7146,   7122,   7098,   7075,   7052,
+          7028,   7005,   6983,   6960,   6937,   6915,   6893,   6871,
+          6849,   6827,   6805,   6784,   6762,   6741,   6720,   6699,
+          6678,   6657,   6637,   6616,   6596,   6575,   6555,   6535,
+          6515,   6495,   6476,   6456,   6437,   6417,   6398,   6379,
+          6360,   6341,   6322,   6303,   6284,   6266,   6247,   6229,
+          6211,   6192,   6174,   6156,   6138,   6121,   6103,   6085,
+          6068,   6050,   6033,   6015,   5998,   5981,   5964,   5947,
+          5930,   5913,   5896,   5880,   5863,   5847,   5830,   5814,
+          5797,   5781,   5765,   5749,   5733,   5717,   5701,   5685,
+          5669,   5654,   5638,   5622,   5607,   5591,   5576,   5561,
+          5545,   5530,   5515,   5500,   5485,   5470,   5455,   5440,
+          5425,   5411,   5396,   5381,   5367,   5352,   5338,   5323,
+          5309,   5295,   5280,   5266,   5252,   5238,   5224,   5210,
+          5196,   5182,   5168,   5154,   5141,   5127,   5113,   5100,
+          5086,   5072,   5059,   5045,   5032,   5019,   5005,   4992,
+          4979,   4966,   4952,   4939,   4926,   4913,   4900,   4887,
+          4874,   4862,   4849,   4836,   4823,   4810,   4798,   4785,
+          4772,   4760,   4747,   4735,   4722,   4710,   4698,   4685,
+          4673,   4661,   4648,   4636,   4624,   4612,   4600,   4588,
+          4575,   4563,   4551,   4539,   4528,   4516,   4504,   4492,
+          4480,   4468,   4457,   4445,   4433,   4422,   4410,   4398,
+          4387,   4375,   4364,   4352,   4341,   4329,   4318,   4306,
+          4295,   4284,   4272,   4261,   4250,   4239,   4227,   4216,
+          4205,   4194,   4183,   4172,   4161,   4150,   4139,   4128,
+          4117,   4106,   4095,   4084,   4073,   4062,   4051,   4041,
+          4030,   4019,   4008,   3998,   3987,   3976,   3966,   3955,
+          3944,   3934,   3923,   3913,   3902,   3892,   3881,   3871,
+          3860,   3850,   3839,   3829,   3819,   3808,   3798,   3788,
+          3777,   3767,   3757,   3747,   3736,   3726,   3716,   3706,
+          3696,   3686,   3675,   3665,   3655,   3645,   3635,   3625,
+          3615,   3605,   3595,   3585,   3575,   3565,   3555,   3545,
+          3536,   3526,   3516,   3506,   3496,   3486,   3476,   3467,
+          3457,   3447,   3437,   3428,   3418,   3408,   3399,   3389,
+          3379,   3370,   3360,   3350,   3341,   3331,   3322,   3312,
+          3302,   3293,   3283,   3274,   3264,   3255,   3245,   3236,
+          3226,   3217,   3207,   3198,   3189,   3179,   3170,   3160,
+          3151,   3142,   3132,   3123,   3114,   3104,   3095,   3086,
+          3077,   3067,   3058,   3049,   3039,   3030,   3021,   3012,
+          3003,   2993,   2984,   2975,   2966,   2957,   2948,   2938,
+          2929,   2920,   2911,   2902,   2893,   2884,   2875,   2866,
+          2857,   2848,   2838,   2829,   2820,   2811,   2802,   2793,
+          2784,   2775,   2766,   2757,   2748,   2739,   2731,   2722,
+          2713,   2704,   2695,   2686,   2677,   2668,   2659,   2650,
+          2641,   2632,   2624,   2615,   2606,   2597,   2588,   2579,
+          2570,   2562,   2553,   2544,   2535,   2526,   2518,   2509,
+          2500,   2491,   2482,   2474,   2465,   2456,   2447,   2439,
+          2430,   2421,   2412,   2404,   2395,   2386,   2377,   2369,
+          2360,   2351,   2343,   2334,   2325,   2316,   2308,   2299,
+          2290,   2282,   2273,   2264,   2256,   2247,   2238,   2230,
+          2221,   2212,   2204,   2195,   2186,   2178,   2169,   2160,
+          2152,   2143,   2134,   2126,   2117,   2109,   2100,   2091,
+          2083,   2074,   2065,   2057,   2048,   2040,   2031,   2022,
+          2014,   2005,   1997,   1988,   1979,   1971,   1962,   1954,
+          1945,   1936,   1928,   1919,   1911,   1902,   1893,   1885,
+          1876,   1868,   1859,   1850,   1842,   1833,   1825,   1816,
+          1807,   1799,   1790,   1782,   1773,   1764,   1756,   1747,
+          1739,   1730,   1721,   1713,   1704,   1696,   1687,   1678,
+          1670,   1661,   1653,   1644,   1635,   1627,   1618,   1609,
+          1601,   1592,   1584,   1575,   1566,   1558,   1549,   1540,
+          1532,   1523,   1514,   1506,   1497,   1489,   1480,   1471,
+          1463,   1454,   1445,   1437,   1428,   1419,   1410,   1402,
+          1393,   1384,   1376,   1367,   1358,   1350,   1341,   1332,
+          1323,   1315,   1306,   1297,   1288,   1280,   1271,   1262,
+          1253,   1245,   1236,   1227,   1218,   1210,   1201,   1192,
+          1183,   1174,   1166,   1157,   1148,   1139,   1130,   1121,
+          1113,   1104,   1095,   1086,   1077,   1068,   1059,   1050,
+          1041,   1033,   1024,   1015,   1006,    997,    988,    979,
+           970,    961,    952,    943,    934,    925,    916,    907,
+           898,    889,    880,    871,    862,    853,    843,    834,
+           825,    816,    807,    798,    789,    780,    770,    761,
+           752,    743,    734,    724,    715,    706,    697,    687,
+           678,    669,    660,    650,    641,    632,    622,    613,
+           604,    594,    585,    575,    566,    556,    547,    538,
+           528,    519,    509,    500,    490,    481,    471,    461,
+           452,    442,    433,    423,    413,    404,    394,    384,
+           375,    365,    355,    345,    336,    326,    316,    306,
+           296,    286,    277,    267,    257,    247,    237,    227,
+           217,    207,    197,    187,    177,    167,    157,    146,
+           136,    126,    116,    106,     96,     85,     75,     65,
+            54,     44,     34,     23,     13,      3,     -8,    -18,
+           -29,    -39,    -50,    -60,    -71,    -82,    -92,   -103,
+          -114,   -124,   -135,   -146,   -157,   -167,   -178,   -189,
+          -200,   -211,   -222,   -233,   -244,   -255,   -266,   -277,
+          -288,   -300,   -311,   -322,   -333,   -345,   -356,   -367,
+          -379,   -390,   -402,   -413,   -425,   -436,   -448,   -459,
+          -471,   -483,   -495,   -506,   -518,   -530,   -542,   -554,
+          -566,   -578,   -590,   -602,   -614,   -626,   -639,   -651,
+          -663,   -676,   -688,   -700,   -713,   -725,   -738,   -751,
+          -763,   -776,   -789,   -802,   -815,   -828,   -841,   -854,
+          -867,   -880,   -893,   -906,   -920,   -933,   -946,   -960,
+          -973,   -987,  -1001,  -1014,  -1028,  -1042,  -1056,  -1070,
+         -1084,  -1098,  -1112,  -1126,  -1141,  -1155,  -1170,  -1184,
+         -1199,  -1213,  -1228,  -1243,  -1258,  -1273,  -1288,  -1303,
+         -1318,  -1334,  -1349,  -1365,  -1380,  -1396,  -1412,  -1427,
+         -1443,  -1459,  -1476,  -1492,  -1508,  -1525,  -1541,  -1558,
+         -1575,  -1591,  -1608,  -1626,  -1643,  -1660,  -1678,  -1695,
+         -1713,  -1731,  -1749,  -1767,  -1785,  -1803,  -1822,  -1840,
+         -1859,  -1878,  -1897,  -1916,  -1936,  -1955,  -1975,  -1995,
+         -2015,  -2035,  -2056,  -2076,  -2097,  -2118,  -2139,  -2161,
+         -2182,  -2204,  -2226,  -2248,  -2271,  -2293,  -2316,  -2339,
+         -2363,  -2386,  -2410,  -2435,  -2459,  -2484,  -2509,  -2534,
+         -2560,  -2586,  -2612,  -2639,  -2666,  -2694,  -2721,  -2750,
+         -2778,  -2807,  -2837,  -2866,  -2897,  -2928,  -2959,  -2991,
+         -3023,  -3056,  -3090,  -3124,  -3159,  -3194,  -3230,  -3267,
+         -3304,  -3343,  -3382,  -3422,  -3463,  -3505,  -3548,  -3592,
+         -3637,  -3684,  -3731,  -3780,  -3831,  -3883,  -3937,  -3992,
+         -4000,  -4000,  -4000,  -4000,  -4000,  -4000,  -4000,  -4000,
+         -4000,  -4000,  -4000,  -4000,  -4000,  -4000,  -4000,  -4000,
+         -4000,  -4000,  -4000,  -4000,  -4000,  -4000,  -4000,  -4000,
+         -4000,
+};
+
+#endif /* THERMISTOR_LUT_H_ */
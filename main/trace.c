@@ -0,0 +1,69 @@
+#include "hal.h"
+#include "trace.h"
+
+const char *const trace_names[TRACE_SCOPES] = {
+        "digits", "fb_flush", "adc_read", "adc_burst", "adc_scan_done",
+        "input_scan", "row_game_scan", "trend_update", "telemetry_kick",
+};
+
+static trace_entry_t table[TRACE_SCOPES];
+static _Atomic uint32_t resets; // Scopes cleared by trace_reset() but not yet zeroed, one bit each
+
+_Static_assert(TRACE_SCOPES <= 32U, "trace resets are a 32 bit mask");
+
+void trace_init(){
+#ifndef HOST_SIM
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/* Everything but the sequence number, which only its recording context moves */
+static void trace_clear(trace_entry_t *entry){
+    entry->count = 0;
+    entry->min = 0;
+    entry->max = 0;
+    entry->sum = 0;
+    for(uint32_t b = 0; b < TRACE_BUCKETS; b++) entry->histogram[b] = 0;
+}
+
+void trace_record(trace_scope_t scope, uint32_t clocks){
+    trace_entry_t *entry = &table[scope];
+    uint32_t bucket = clocks ? 32U - (uint32_t)__builtin_clz(clocks) : 0U;
+    if(bucket >= TRACE_BUCKETS) bucket = TRACE_BUCKETS - 1U;
+    uint32_t bit = 1U << scope;
+
+    uint32_t seq = atomic_load(&entry->seq);
+    atomic_store(&entry->seq, seq + 1U);
+    if(atomic_load(&resets) & bit){
+        atomic_fetch_and(&resets, ~bit);
+        trace_clear(entry);
+    }
+    if(entry->count == 0 || clocks < entry->min) entry->min = clocks;
+    if(clocks > entry->max) entry->max = clocks;
+    entry->sum += clocks;
+    entry->histogram[bucket]++;
+    entry->count++;
+    atomic_store(&entry->seq, seq + 2U);
+}
+
+void trace_reset(){
+    atomic_fetch_or(&resets, UINT32_MAX >> (32U - TRACE_SCOPES));
+}
+
+bool trace_snapshot(trace_scope_t scope, trace_entry_t *out){
+    const trace_entry_t *entry = &table[scope];
+    uint32_t seq = atomic_load(&entry->seq);
+    if(seq & 1U) return 0;
+
+    out->count = entry->count;
+    out->min = entry->min;
+    out->max = entry->max;
+    out->sum = entry->sum;
+    for(uint32_t b = 0; b < TRACE_BUCKETS; b++) out->histogram[b] = entry->histogram[b];
+    if(atomic_load(&entry->seq) != seq) return 0;
+
+    if(atomic_load(&resets) & (1U << scope)) trace_clear(out);
+    return 1;
+}
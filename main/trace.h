@@ -0,0 +1,101 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdatomic.h>
+#include "hal.h"
+
+#ifdef HOST_SIM
+#include <time.h>
+#endif
+
+/*
+ * HOT-PATH TRACING
+ * TRACE_BEGIN(scope) / TRACE_END(scope) around a piece of code record how
+ * long it ran into a static per-scope table: count, min, max, mean and a
+ * log2 histogram. On the board the clock is the DWT cycle counter (core
+ * cycles, it stops in WFI, so a scope should not span hal_idle()); in the
+ * host build it is clock_gettime() in ns. A scope is recorded from one
+ * context only (task or a single interrupt).
+ *
+ * Built without TRACE_ENABLE=1 the macros expand to nothing, the table
+ * stays empty and the traced code is unchanged.
+ *
+ * The console (telemetry.c) dumps the table as TELEMETRY_TRACE records on
+ * 'd' and clears it on 'r'. Neither takes a critical section: an entry
+ * carries a sequence number that is odd while trace_record() is inside it,
+ * a reset only marks the scopes and the recording context clears its own
+ * entry on its next run.
+ */
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 0
+#endif
+
+#ifdef HOST_SIM
+#define TRACE_CLOCK_HZ 1000000000U
+#else
+#define TRACE_CLOCK_HZ HAL_TIMER_CLOCK_HZ
+#endif
+
+/* Bucket 0 counts zero-length runs, bucket b >= 1 runs of [2^(b-1), 2^b) clocks, the last one the rest */
+#define TRACE_BUCKETS 24U
+
+typedef enum {
+    TRACE_DIGITS = 0,     // numfield_set(): a value into its glyph cells
+    TRACE_FB_FLUSH,       // fb_flush(): diff and queue of the dirty columns
+    TRACE_ADC_READ,       // Blocking LPADC conversion (hal_adc_read)
+    TRACE_ADC_BURST,      // One entropy block of floating pin conversions
+    TRACE_ADC_SCAN_DONE,  // ADC scan DMA interrupt: filters, history, telemetry
+    TRACE_INPUT_SCAN,     // 1 ms NAV/DIP sampling and debounce
+    TRACE_ROW_GAME_SCAN,  // One pass of the row game over the NAV buttons
+    TRACE_TREND_UPDATE,   // trend_update() with new points
+    TRACE_TELEMETRY_KICK, // CRC and COBS pass of a telemetry frame
+    TRACE_SCOPES
+} trace_scope_t;
+
+typedef struct {
+    _Atomic uint32_t seq; // Odd while trace_record() is updating the entry
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t histogram[TRACE_BUCKETS];
+} trace_entry_t;
+
+extern const char *const trace_names[TRACE_SCOPES];
+
+/* Free-running trace clock, TRACE_CLOCK_HZ */
+static inline uint32_t trace_now(){
+#ifdef HOST_SIM
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+#if TRACE_ENABLE
+#define TRACE_BEGIN(scope) uint32_t trace_start_##scope = trace_now()
+#define TRACE_END(scope)   trace_record((scope), trace_now() - trace_start_##scope)
+#else
+#define TRACE_BEGIN(scope) ((void)0)
+#define TRACE_END(scope)   ((void)0)
+#endif
+
+/* Starts the DWT cycle counter, called once from main() */
+void trace_init();
+
+/* Adds one run of 'clocks' to the scope */
+void trace_record(trace_scope_t scope, uint32_t clocks);
+
+/* Clears every scope, from any context; each one is zeroed by its own
+ * recording context and reads back empty until then */
+void trace_reset();
+
+/* Consistent copy of one scope; 0 when the copy raced a trace_record() of
+ * the scope, the caller tries again later instead of waiting on a context
+ * it may have preempted */
+bool trace_snapshot(trace_scope_t scope, trace_entry_t *out);
+
+#endif /* TRACE_H_ */
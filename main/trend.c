@@ -0,0 +1,106 @@
+#include "hal.h"
+#include "oled_fb.h"
+#include "oled_cmd.h"
+#include "history.h"
+#include "trace.h"
+#include "trend.h"
+
+trend_stats_t trend_stats;
+
+static int32_t trend_value(const trend_t *trend, uint16_t raw){
+    return trend->units ? trend->units(raw) : (int32_t)raw;
+}
+
+/* Bar of one point, filled up from the bottom row, at least one pixel high */
+static void trend_column(const trend_t *trend, uint8_t column, uint16_t raw){
+    int32_t offset = trend_value(trend, raw) - trend->lo;
+    if(offset < 0) offset = 0;
+    if(offset > trend->span) offset = trend->span;
+    uint32_t height = 1U + (uint32_t)offset * (TREND_HEIGHT - 1U) / (uint32_t)trend->span;
+
+    for(uint8_t p = TREND_PAGE1; p >= TREND_PAGE0; p--){
+        uint8_t bits = (height >= 8U) ? 0xFFU : (uint8_t)(0xFF00U >> height); // Bit 7 is the bottom row
+        height = (height >= 8U) ? height - 8U : 0U;
+        fb_draw(p, column, &bits, 1U);
+    }
+}
+
+/* Scale over the values in the window, with an eighth of headroom on both sides */
+static void trend_fit(trend_t *trend, const history_point_t *points, uint32_t count){
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for(uint32_t i = 0; i < count; i++){
+        int32_t value = trend_value(trend, points[i].mean);
+        if(value < lo) lo = value;
+        if(value > hi) hi = value;
+    }
+    int32_t span = hi - lo;
+    if(span < TREND_MIN_SPAN) span = TREND_MIN_SPAN;
+    trend->lo = lo - (span - (hi - lo)) / 2 - span / 8;
+    trend->span = span + span / 4;
+}
+
+/* The newest 'count' points and the total they end at, read again if a point lands in between */
+static uint32_t trend_read(const trend_t *trend, history_point_t *points, uint32_t count, uint32_t *total){
+    uint32_t read;
+    do {
+        *total = history_total(trend->sensor, HISTORY_MINUTE);
+        read = history_points(trend->sensor, HISTORY_MINUTE, points, count);
+    } while(history_total(trend->sensor, HISTORY_MINUTE) != *total);
+    return read;
+}
+
+static void trend_redraw(trend_t *trend){
+    history_point_t points[TREND_COLUMNS];
+    uint32_t count = trend_read(trend, points, TREND_COLUMNS, &trend->total);
+
+    if(count > 0) trend_fit(trend, points, count);
+    for(uint32_t p = TREND_PAGE0; p <= TREND_PAGE1; p++) fb_clear_area((uint8_t)p, TREND_COL0, TREND_COLUMNS);
+    for(uint32_t i = 0; i < count; i++){
+        trend_column(trend, (uint8_t)(TREND_COL1 + 1U - count + i), points[i].mean);
+    }
+    fb_flush();
+    trend_stats.redraws++;
+}
+
+void trend_start(trend_t *trend, adc_scan_channel_t sensor, trend_units_t units){
+    trend->sensor = sensor;
+    trend->units = units;
+    trend->lo = 0;
+    trend->span = TREND_MIN_SPAN;
+    trend_redraw(trend);
+}
+
+/* Scrolls in the point added since the last update, or redraws when there are more */
+static void trend_advance(trend_t *trend){
+    history_point_t points[TREND_COLUMNS];
+    uint32_t total;
+    uint32_t count = trend_read(trend, points, TREND_COLUMNS, &total);
+    uint32_t added = total - trend->total;
+    if(added > 1U || added > count){
+        /* Scrolls back to back would come faster than the controller takes them */
+        trend_redraw(trend);
+        return;
+    }
+    const history_point_t *fresh = &points[count - 1U];
+    int32_t value = trend_value(trend, fresh->mean);
+    if(value < trend->lo || value > trend->lo + trend->span){
+        trend_redraw(trend);
+        return;
+    }
+    uint32_t before = oledc_stats.bus_bytes;
+    fb_scroll_left(TREND_PAGE0, TREND_PAGE1, TREND_COL0, TREND_COL1);
+    trend_column(trend, TREND_COL1, fresh->mean);
+    fb_flush();
+    trend_stats.scrolled++;
+    trend_stats.scroll_bytes += oledc_stats.bus_bytes - before;
+    trend->total = total;
+}
+
+bool trend_update(trend_t *trend){
+    if(history_total(trend->sensor, HISTORY_MINUTE) == trend->total) return 0;
+
+    TRACE_BEGIN(TRACE_TREND_UPDATE);
+    trend_advance(trend);
+    TRACE_END(TRACE_TREND_UPDATE);
+    return 1;
+}
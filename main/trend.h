@@ -0,0 +1,52 @@
+#ifndef TREND_H_
+#define TREND_H_
+
+#include "hal.h"
+#include "oled_fb.h"
+#include "history.h"
+
+/*
+ * TREND GRAPH
+ * Bar graph of the last minute of a sensor (the 1 s points of its history
+ * minute tier) on pages TREND_PAGE0..TREND_PAGE1, newest point on the right.
+ * A new point scrolls the graph one column to the left in the controller
+ * (fb_scroll_left) and only its own column is sent; several points at once
+ * redraw the window, the controller taking one scroll per ~30 ms. The vertical scale is
+ * fitted to the window when the graph starts and refitted, with a full
+ * redraw, only when a point falls outside it.
+ */
+
+#define TREND_PAGE0   2U
+#define TREND_PAGE1   7U
+#define TREND_HEIGHT  ((TREND_PAGE1 - TREND_PAGE0 + 1U) * 8U)
+#define TREND_COLUMNS HISTORY_MINUTE_POINTS
+#define TREND_COL1    (FB_COLUMNS - 1U)
+#define TREND_COL0    (TREND_COL1 + 1U - TREND_COLUMNS)
+#define TREND_MIN_SPAN 16   // Smallest scale in display units, keeps noise flat
+
+/* Display units of a history value, e.g. 0.01 degC; NULL plots the raw counts */
+typedef int32_t (*trend_units_t)(uint16_t raw);
+
+typedef struct {
+    adc_scan_channel_t sensor;
+    trend_units_t units;
+    uint32_t total;   // history_total() of the newest point drawn
+    int32_t lo;       // Value at the bottom of the graph
+    int32_t span;     // Values from the bottom to the top row
+} trend_t;
+
+typedef struct {
+    uint32_t scrolled;      // Points added by a scroll and one column
+    uint32_t redraws;       // Full redraws: start, rescale or more than one point behind
+    uint32_t scroll_bytes;  // Bus bytes of the scrolled points, scroll command included
+} trend_stats_t;
+
+extern trend_stats_t trend_stats;
+
+/* Fits the scale and draws the whole window */
+void trend_start(trend_t *trend, adc_scan_channel_t sensor, trend_units_t units);
+
+/* Adds the points that arrived since the last call, returns 1 if the graph changed */
+bool trend_update(trend_t *trend);
+
+#endif /* TREND_H_ */
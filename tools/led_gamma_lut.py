@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+"""
+Generates main/led_gamma_lut.h, the brightness -> PWM duty table used by
+led_ring.c. Run it whenever the gamma or the PWM resolution changes:
+
+    python3 tools/led_gamma_lut.py > main/led_gamma_lut.h
+
+Levels are perceived brightness 0..255; the duty is in PWM slots out of
+2^BITS per frame, duty = round((2^BITS - 1) * (level / 255)^gamma). Any
+level above 0 keeps at least one slot, so the dimmest steps stay visible.
+"""
+
+import argparse
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--gamma", type=float, default=2.2, help="Display gamma")
+    parser.add_argument("--bits", type=int, default=8, help="log2 of the PWM slots per frame")
+    args = parser.parse_args()
+
+    top = (1 << args.bits) - 1
+    table = [0] + [max(1, round(top * (level / 255) ** args.gamma)) for level in range(1, 256)]
+
+    print("/* Generated by tools/led_gamma_lut.py, do not edit */")
+    print("#ifndef LED_GAMMA_LUT_H_")
+    print("#define LED_GAMMA_LUT_H_")
+    print()
+    print("/* Gamma %g, %u PWM slots per frame */" % (args.gamma, 1 << args.bits))
+    print()
+    print("#define LED_GAMMA_SLOTS %uU" % (1 << args.bits))
+    print()
+    print("static const uint%d_t led_gamma_lut[256] = {" % (8 if args.bits <= 8 else 16))
+    for i in range(0, 256, 16):
+        print("        " + " ".join("%3d," % v for v in table[i:i + 16]))
+    print("};")
+    print()
+    print("#endif /* LED_GAMMA_LUT_H_ */")
+
+
+if __name__ == "__main__":
+    main()
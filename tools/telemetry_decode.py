@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""
+Decodes the binary telemetry stream of main/telemetry.c into CSV, one row
+per value:
+
+    python3 tools/telemetry_decode.py capture.bin > telemetry.csv
+    cat /dev/ttyACM0 | python3 tools/telemetry_decode.py > telemetry.csv
+
+Trace records (sent on the 'd' console command) give the times in ns,
+histogram bucket b counting runs of [2^(b-1), 2^b) trace clocks.
+
+Frames end with 0x00 and are COBS-encoded; inside, a sequence byte, the
+base time in ms and the records as LEB128 varints, then a CRC-16/CCITT-FALSE
+(little endian). Frames with a bad CRC are skipped; sequence gaps and CRC
+errors are counted on stderr.
+"""
+
+import argparse
+import sys
+
+SCAN, INPUT, COUNTERS, TRACE = 1, 2, 3, 4
+
+CHANNELS = ["thermistor", "photodiode", "potentiometer"]  # adc_scan_channel_t
+BUTTONS = ["sw1", "sw2", "sw3", "sw4", "back", "nav_left", "nav_right", "nav_up", "nav_down",
+           "dip1", "dip2", "dip3", "dip4", "dip5", "dip6", "dip7", "dip8"]  # input_button_t
+EDGES = ["press", "release"]
+MODULES = ["menu", "temperature", "light", "game", "leds"]  # hal_module_t
+COUNTER_NAMES = ["idle_permille_" + m for m in MODULES] + [
+    "adc_missed", "input_overflows", "input_bounces", "oled_frames_dropped", "telemetry_dropped"]
+TRACE_SCOPES = ["digits", "fb_flush", "adc_read", "adc_burst", "adc_scan_done", "input_scan", "row_game_scan",
+                "trend_update", "telemetry_kick"]  # trace_scope_t
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def zigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def records(frame):
+    """Yields (time_ms, kind, key, value) for every value in a checked frame."""
+    time, pos = varint(frame, 1)
+    last = [0] * len(CHANNELS)
+    while pos < len(frame):
+        tag = frame[pos]
+        dt, pos = varint(frame, pos + 1)
+        time += dt
+        if tag == SCAN:
+            for i, name in enumerate(CHANNELS):
+                delta, pos = varint(frame, pos)
+                last[i] += zigzag(delta)
+                yield time, "scan", name, last[i]
+        elif tag == INPUT:
+            code, pos = varint(frame, pos)
+            button = BUTTONS[code >> 1] if (code >> 1) < len(BUTTONS) else str(code >> 1)
+            yield time, "input", button, EDGES[code & 1]
+        elif tag == COUNTERS:
+            for name in COUNTER_NAMES:
+                value, pos = varint(frame, pos)
+                yield time, "counter", name, value
+        elif tag == TRACE:
+            fields = []
+            for _ in range(8):
+                value, pos = varint(frame, pos)
+                fields.append(value)
+            scope, clock_khz, count, low, high, mean, first, buckets = fields
+            name = TRACE_SCOPES[scope] if scope < len(TRACE_SCOPES) else str(scope)
+            yield time, "trace", name + ".count", count
+            for key, clocks in (("min", low), ("mean", mean), ("max", high)):
+                yield time, "trace", name + "." + key + "_ns", round(clocks * 1e6 / clock_khz)
+            for bucket in range(first, first + buckets):
+                value, pos = varint(frame, pos)
+                yield time, "trace", "%s.bucket%d" % (name, bucket), value
+        else:
+            raise ValueError("unknown record tag %d" % tag)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="Raw stream, stdin if omitted")
+    args = parser.parse_args()
+
+    stream = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+    out = sys.stdout
+    out.write("time_ms,kind,key,value\n")
+
+    frames = crc_errors = gaps = 0
+    sequence = None
+    pending = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        pending += chunk
+        *complete, rest = pending.split(b"\x00")
+        pending = bytearray(rest)
+        for encoded in complete:
+            if not encoded:
+                continue
+            try:
+                frame = cobs_decode(encoded)
+            except ValueError:
+                crc_errors += 1
+                continue
+            if len(frame) < 4 or crc16(frame[:-2]) != frame[-2] | frame[-1] << 8:
+                crc_errors += 1
+                continue
+            frame = frame[:-2]
+            if sequence is not None and frame[0] != (sequence + 1) & 0xFF:
+                gaps += 1
+            sequence = frame[0]
+            frames += 1
+            try:
+                for time, kind, key, value in records(frame):
+                    out.write("%d,%s,%s,%s\n" % (time, kind, key, value))
+            except (IndexError, ValueError):
+                crc_errors += 1
+
+    sys.stderr.write("%d frames, %d bad, %d sequence gaps\n" % (frames, crc_errors, gaps))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+Generates main/thermistor_lut.h, the ADC code -> temperature table used by
+thermistor.c. Run it whenever the thermistor or the divider changes:
+
+    python3 tools/thermistor_lut.py > main/thermistor_lut.h
+
+The NTC sits on the low side of a divider fed from the ADC reference, so the
+16-bit result is ratiometric: code = 65536 * Rt / (Rt + Rs). The resistance is
+converted with the Beta equation, or with Steinhart-Hart when --sh is given.
+Entries are in 0.01 degC, one every 2^SHIFT codes, and are clamped to the
+rated range of the part.
+"""
+
+import argparse
+import math
+
+ADC_BITS = 16
+
+
+def kelvin_beta(r, args):
+    t0 = 25.0 + 273.15
+    return 1.0 / (1.0 / t0 + math.log(r / args.r25) / args.beta)
+
+
+def kelvin_sh(r, args):
+    a, b, c = args.sh
+    ln = math.log(r)
+    return 1.0 / (a + b * ln + c * ln ** 3)
+
+
+def celsius(code, args):
+    """Exact temperature for an ADC code, clamped to the table range"""
+    if code <= 0:
+        return args.t_max
+    if code >= (1 << ADC_BITS):
+        return args.t_min
+    r = args.series * code / ((1 << ADC_BITS) - code)
+    kelvin = kelvin_sh(r, args) if args.sh else kelvin_beta(r, args)
+    return min(max(kelvin - 273.15, args.t_min), args.t_max)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--r25", type=float, default=10000.0, help="NTC resistance at 25 degC (ohm)")
+    parser.add_argument("--beta", type=float, default=3950.0, help="Beta constant (K)")
+    parser.add_argument("--sh", type=float, nargs=3, metavar=("A", "B", "C"),
+                        help="Steinhart-Hart coefficients, override --r25/--beta")
+    parser.add_argument("--series", type=float, default=10000.0, help="High side resistor (ohm)")
+    parser.add_argument("--t-min", type=float, default=-40.0, help="Lowest temperature (degC)")
+    parser.add_argument("--t-max", type=float, default=125.0, help="Highest temperature (degC)")
+    parser.add_argument("--shift", type=int, default=6, help="log2 of the codes between entries")
+    args = parser.parse_args()
+
+    step = 1 << args.shift
+    entries = (1 << (ADC_BITS - args.shift)) + 1
+    table = [round(celsius(i * step, args) * 100) for i in range(entries)]
+
+    # Worst case of the runtime interpolation against the exact curve, over the
+    # segments that lie inside the rated range (the two at the clamp knees do not)
+    limits = (round(args.t_min * 100), round(args.t_max * 100))
+    worst = 0
+    for code in range(1 << ADC_BITS):
+        i, frac = code >> args.shift, code & (step - 1)
+        if table[i] in limits or table[i + 1] in limits:
+            continue
+        approx = table[i] + int((table[i + 1] - table[i]) * frac / step)
+        worst = max(worst, abs(approx - celsius(code, args) * 100))
+
+    if args.sh:
+        model = "Steinhart-Hart A=%g B=%g C=%g" % tuple(args.sh)
+    else:
+        model = "Beta R25=%g ohm B=%g K" % (args.r25, args.beta)
+
+    print("/* Generated by tools/thermistor_lut.py, do not edit */")
+    print("#ifndef THERMISTOR_LUT_H_")
+    print("#define THERMISTOR_LUT_H_")
+    print()
+    print("/* %s, series %g ohm, %g..%g degC" % (model, args.series, args.t_min, args.t_max))
+    print(" * Interpolation error <= %.3f degC inside the range */" % (worst / 100))
+    print()
+    print("#define THERMISTOR_LUT_SHIFT   %uU" % args.shift)
+    print("#define THERMISTOR_LUT_ENTRIES %uU" % entries)
+    print()
+    print("static const int16_t thermistor_lut[THERMISTOR_LUT_ENTRIES] = {")
+    for i in range(0, entries, 8):
+        print("        " + " ".join("%6d," % v for v in table[i:i + 8]))
+    print("};")
+    print()
+    print("#endif /* THERMISTOR_LUT_H_ */")
+
+
+if __name__ == "__main__":
+    main()